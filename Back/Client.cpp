@@ -0,0 +1,140 @@
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include "Server.hpp"
+
+/*
+ * A request is a header of the payload size, sent with the client's stdout and stderr attached as SCM_RIGHTS, then
+ * the payload, which is the client's working directory and arguments, each ending in '\0'. The server compiles it
+ * writing straight to the client's stdout and stderr, and replies with the exit status.
+ */
+
+/**
+ * Gets the path of the server's socket, from ACC_SERVER_SOCKET or else one per user in /tmp.
+ */
+std::string get_server_socket_path()
+{
+    auto path = std::getenv("ACC_SERVER_SOCKET");
+    return path != nullptr ? path : "/tmp/acc-" + std::to_string(getuid()) + ".sock";
+}
+
+/**
+ * Makes the address of the socket.
+ */
+sockaddr_un make_address(const std::string& socket_path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("socket path is too long: " + socket_path);
+    }
+
+    std::strcpy(address.sun_path, socket_path.c_str());
+    return address;
+}
+
+/**
+ * Reads exactly size bytes, returning false if the other end closed the connection first.
+ */
+bool read_all(int fd, void *buffer, std::size_t size)
+{
+    auto bytes = (char *)buffer;
+    while (size > 0)
+    {
+        auto count = read(fd, bytes, size);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (count <= 0)
+        {
+            return false;
+        }
+
+        bytes += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+/**
+ * Writes exactly size bytes, returning false if the other end closed the connection.
+ */
+bool write_all(int fd, const void *buffer, std::size_t size)
+{
+    auto bytes = (const char *)buffer;
+    while (size > 0)
+    {
+        auto count = write(fd, bytes, size);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (count <= 0)
+        {
+            return false;
+        }
+
+        bytes += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+/**
+ * Sends the arguments to the server to compile in the working directory, and returns the exit status of the
+ * compilation. The server writes the output and errors straight to this process's stdout and stderr.
+ */
+int run_client(const std::string& socket_path, const std::vector<std::string>& args)
+{
+    auto address = make_address(socket_path);
+    auto connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0 || connect(connection, (sockaddr *)&address, sizeof(address)) < 0)
+    {
+        throw std::runtime_error("could not connect to the server on " + socket_path + ": " + std::strerror(errno));
+    }
+
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == nullptr)
+    {
+        throw std::runtime_error("could not get the working directory");
+    }
+
+    std::string payload = std::string(cwd) + '\0';
+    for (auto& arg : args)
+    {
+        payload += arg + '\0';
+    }
+
+    std::uint32_t size = payload.size();
+    int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+    char control[CMSG_SPACE(sizeof(fds))] = {};
+    iovec vector = { &size, sizeof(size) };
+    msghdr message = {};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    auto header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+    std::int32_t status;
+    if (sendmsg(connection, &message, 0) != sizeof(size) || !write_all(connection, payload.data(), payload.size()) || !read_all(connection, &status, sizeof(status)))
+    {
+        // the server exits without replying if the compilation stops with an error
+        status = 1;
+    }
+
+    close(connection);
+    return status;
+}
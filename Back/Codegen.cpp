@@ -7,7 +7,10 @@
 #include <llvm/ADT/APInt.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/IR/Module.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Intrinsics.h>
 #include <llvm/Support/raw_os_ostream.h>
+#include <llvm/Support/TimeProfiler.h>
 #include "Type.hpp"
 #include "CodegenContext.hpp"
 #include "Codegen.hpp"
@@ -30,9 +33,15 @@ static llvm::Type *get_llvm_type(std::shared_ptr<Type> type, CodegenContext& con
         case TypeType::Void:
             return llvm::Type::getVoidTy(*context.llvm_context);
         case TypeType::Int:
-            return llvm::Type::getInt32Ty(*context.llvm_context);
         case TypeType::Char:
-            return llvm::Type::getInt8Ty(*context.llvm_context);
+        case TypeType::Short:
+        case TypeType::Long:
+            // signedness is a property of the operations, not of the LLVM type
+            return llvm::Type::getIntNTy(*context.llvm_context, type->size() * 8);
+        case TypeType::Float:
+            return llvm::Type::getFloatTy(*context.llvm_context);
+        case TypeType::Double:
+            return llvm::Type::getDoubleTy(*context.llvm_context);
         case TypeType::Array:
         {
             auto elem_type = get_llvm_type(type->elem_type, context);
@@ -50,6 +59,8 @@ static llvm::Type *get_llvm_type(std::shared_ptr<Type> type, CodegenContext& con
             auto elem_type = get_llvm_type(type->elem_type, context);
             return elem_type->getPointerTo();
         }
+        case TypeType::Vector:
+            return llvm::FixedVectorType::get(get_llvm_type(type->elem_type, context), type->num_elems.value());
         default:
             return nullptr; // TODO handle later
     }
@@ -62,12 +73,19 @@ static llvm::Constant *get_default_value(std::shared_ptr<Type> type, CodegenCont
         case TypeType::Void:
             return nullptr;
         case TypeType::Int:
-            return context.llvm_builder->getInt32(0);
         case TypeType::Char:
-            return context.llvm_builder->getInt8(0);
-        case TypeType::Function:
+        case TypeType::Short:
+        case TypeType::Long:
+            return llvm::ConstantInt::get(get_llvm_type(type, context), 0);
+        case TypeType::Float:
+        case TypeType::Double:
+            return llvm::ConstantFP::get(get_llvm_type(type, context), 0.0);
+        case TypeType::Vector:
         case TypeType::Array:
         case TypeType::Pointer:
+            // an array of known size is a zeroinitializer of the array type, and any other array is a null pointer
+            return llvm::Constant::getNullValue(get_llvm_type(type, context));
+        case TypeType::Function:
             return nullptr;
     }
 }
@@ -96,6 +114,7 @@ static bool is_terminator(std::shared_ptr<Quad> quad)
         case QuadOp::IfLeq:
         case QuadOp::IfGt:
         case QuadOp::IfGeq:
+        case QuadOp::Switch:
         case QuadOp::Return:
             return true;
         default:
@@ -103,6 +122,56 @@ static bool is_terminator(std::shared_ptr<Quad> quad)
     }
 }
 
+/**
+ * Creates the TBAA tags for accesses of each type, so that LLVM knows that e.g. an int store does not change a long.
+ * C lets a char access any object, so char is the parent of the other types, and unsigned types share the tag of the
+ * signed type.
+ */
+static void create_tbaa_tags(CodegenContext& context)
+{
+    llvm::MDBuilder builder(*context.llvm_context);
+    auto root = builder.createTBAARoot("acc TBAA");
+    auto char_node = builder.createTBAAScalarTypeNode("omnipotent char", root);
+    context.tbaa_tags[TypeType::Char] = builder.createTBAAStructTagNode(char_node, char_node, 0);
+
+    std::vector<std::pair<TypeType, std::string>> types = {
+        { TypeType::Short, "short" },
+        { TypeType::Int, "int" },
+        { TypeType::Long, "long" },
+        { TypeType::Float, "float" },
+        { TypeType::Double, "double" },
+        { TypeType::Pointer, "any pointer" },
+    };
+
+    for (auto& [type, name] : types)
+    {
+        auto node = builder.createTBAAScalarTypeNode(name, char_node);
+        context.tbaa_tags[type] = builder.createTBAAStructTagNode(node, node, 0);
+    }
+}
+
+/**
+ * Attaches the TBAA tag for an access of a value of the type to the load or store. A vector access has the tag of its
+ * elements, and a stored array parameter is a pointer.
+ */
+static llvm::Instruction *add_tbaa(llvm::Instruction *inst, std::shared_ptr<Type> type, CodegenContext& context)
+{
+    if (context.tbaa_tags.empty())
+    {
+        create_tbaa_tags(context);
+    }
+
+    auto access_type = type->type == TypeType::Vector ? type->elem_type->type : type->type;
+    access_type = access_type == TypeType::Array ? TypeType::Pointer : access_type;
+    auto tag = context.tbaa_tags.find(access_type);
+    if (tag != context.tbaa_tags.end())
+    {
+        inst->setMetadata(llvm::LLVMContext::MD_tbaa, tag->second);
+    }
+
+    return inst;
+}
+
 /**
  * Stores a value in a variable.
  */
@@ -114,19 +183,41 @@ static void store(std::shared_ptr<Symbol> symbol, llvm::Value *val, CodegenConte
     }
     else
     {   
-        context.llvm_builder->CreateStore(val, symbol->symbol_data.value, false);
+        add_tbaa(context.llvm_builder->CreateStore(val, symbol->symbol_data.value, false), symbol->type, context);
     }
 }
 
 /**
- * Generates LLVM code for an operand.
+ * Generates LLVM code for an operand. Constants are created with the type hint, 
+ * or as an i32 or a double if there is none.
  */
-static llvm::Value *codegen(std::shared_ptr<Operand> operand, CodegenContext& context)
+static llvm::Value *codegen(std::shared_ptr<Operand> operand, CodegenContext& context, llvm::Type *type_hint = nullptr)
 {
+    if (type_hint != nullptr && type_hint->isVectorTy() && operand->type != OperandType::Variable)
+    {
+        // a constant with a vector hint is the same constant in every element
+        auto vector_type = llvm::cast<llvm::FixedVectorType>(type_hint);
+        auto elem = llvm::cast<llvm::Constant>(codegen(operand, context, vector_type->getElementType()));
+        return llvm::ConstantVector::getSplat(vector_type->getElementCount(), elem);
+    }
+
     switch (operand->type)
     {
         case OperandType::IntConst:
-            return llvm::ConstantInt::get(*context.llvm_context, llvm::APInt(32, operand->iconst));
+        {
+            if (type_hint != nullptr && type_hint->isFloatingPointTy())
+            {
+                return llvm::ConstantFP::get(type_hint, (double)operand->iconst);
+            }
+
+            auto type = type_hint != nullptr && type_hint->isIntegerTy() ? type_hint : context.llvm_builder->getInt32Ty();
+            return llvm::ConstantInt::get(type, operand->iconst, true);
+        }
+        case OperandType::FloatConst:
+        {
+            auto type = type_hint != nullptr && type_hint->isFloatingPointTy() ? type_hint : context.llvm_builder->getDoubleTy();
+            return llvm::ConstantFP::get(type, operand->fconst);
+        }
         case OperandType::StrConst:
             return nullptr; // TODO
         case OperandType::Variable:
@@ -142,9 +233,10 @@ static llvm::Value *codegen(std::shared_ptr<Operand> operand, CodegenContext& co
                 }
                 else
                 {
-                    return context.llvm_builder->CreateLoad(
+                    auto load = context.llvm_builder->CreateLoad(
                         get_llvm_type(operand->symbol->type, context), 
                         operand->symbol->symbol_data.value);
+                    return add_tbaa(load, operand->symbol->type, context);
                 }
             }
         case OperandType::Label:
@@ -152,6 +244,23 @@ static llvm::Value *codegen(std::shared_ptr<Operand> operand, CodegenContext& co
     }
 }
 
+/**
+ * Gets the type that the operands of an instruction are operated on in, i.e. the type of the first variable operand,
+ * or the type of the result if all of the operands are constants.
+ */
+static std::shared_ptr<Type> get_operand_type(std::shared_ptr<Quad> quad)
+{
+    for (auto& operand : { quad->arg1, quad->arg2, quad->res })
+    {
+        if (operand != nullptr && operand->type == OperandType::Variable)
+        {
+            return operand->symbol->type;
+        }
+    }
+
+    return std::make_shared<Type>(TypeType::Int);
+}
+
 /**
  * Generates LLVM code for a param instruction.
  */
@@ -160,8 +269,9 @@ static llvm::Value *codegen_param(std::shared_ptr<Quad> quad, CodegenContext& co
     auto value = codegen(quad->arg1, context);
     if (quad->arg1->type == OperandType::Variable && quad->arg1->symbol->type->type == TypeType::Array)
     { // TODO instead, create a typecase node in the IR
-        auto elem_type = get_llvm_type(quad->arg1->symbol->type->elem_type, context);
-        value = context.llvm_builder->CreateGEP(elem_type, value, context.llvm_builder->getInt32(0));
+        // the array decays to a pointer to its first element
+        auto array_type = get_llvm_type(quad->arg1->symbol->type, context);
+        value = context.llvm_builder->CreateInBoundsGEP(array_type, value, { context.llvm_builder->getInt64(0), context.llvm_builder->getInt64(0) });
     }
 
     context.param_stack.push_back(value);
@@ -193,6 +303,122 @@ static llvm::Value *codegen_call(std::shared_ptr<Quad> quad, CodegenContext& con
     return func_call;
 }
 
+/**
+ * Gets the integer comparison predicate for a comparison or if instruction.
+ */
+static llvm::CmpInst::Predicate get_icmp_predicate(QuadOp op, bool is_unsigned)
+{
+    switch (op)
+    {
+        case QuadOp::Eq:
+        case QuadOp::IfEq:
+            return llvm::CmpInst::Predicate::ICMP_EQ;
+        case QuadOp::Neq:
+        case QuadOp::IfNeq:
+            return llvm::CmpInst::Predicate::ICMP_NE;
+        case QuadOp::Lt:
+        case QuadOp::IfLt:
+            return is_unsigned ? llvm::CmpInst::Predicate::ICMP_ULT : llvm::CmpInst::Predicate::ICMP_SLT;
+        case QuadOp::Leq:
+        case QuadOp::IfLeq:
+            return is_unsigned ? llvm::CmpInst::Predicate::ICMP_ULE : llvm::CmpInst::Predicate::ICMP_SLE;
+        case QuadOp::Gt:
+        case QuadOp::IfGt:
+            return is_unsigned ? llvm::CmpInst::Predicate::ICMP_UGT : llvm::CmpInst::Predicate::ICMP_SGT;
+        case QuadOp::Geq:
+        case QuadOp::IfGeq:
+            return is_unsigned ? llvm::CmpInst::Predicate::ICMP_UGE : llvm::CmpInst::Predicate::ICMP_SGE;
+        default:
+            assert(false && "not a comparison");
+            return llvm::CmpInst::Predicate::BAD_ICMP_PREDICATE;
+    }
+}
+
+/**
+ * Gets the floating point comparison predicate for a comparison or if instruction.
+ * The comparisons are ordered, i.e. false if either operand is NaN, except for != which is true.
+ */
+static llvm::CmpInst::Predicate get_fcmp_predicate(QuadOp op)
+{
+    switch (op)
+    {
+        case QuadOp::Eq:
+        case QuadOp::IfEq:
+            return llvm::CmpInst::Predicate::FCMP_OEQ;
+        case QuadOp::Neq:
+        case QuadOp::IfNeq:
+            return llvm::CmpInst::Predicate::FCMP_UNE;
+        case QuadOp::Lt:
+        case QuadOp::IfLt:
+            return llvm::CmpInst::Predicate::FCMP_OLT;
+        case QuadOp::Leq:
+        case QuadOp::IfLeq:
+            return llvm::CmpInst::Predicate::FCMP_OLE;
+        case QuadOp::Gt:
+        case QuadOp::IfGt:
+            return llvm::CmpInst::Predicate::FCMP_OGT;
+        case QuadOp::Geq:
+        case QuadOp::IfGeq:
+            return llvm::CmpInst::Predicate::FCMP_OGE;
+        default:
+            assert(false && "not a comparison");
+            return llvm::CmpInst::Predicate::BAD_FCMP_PREDICATE;
+    }
+}
+
+/**
+ * Gets the comparison predicate for a comparison or if instruction on operands of the type.
+ */
+static llvm::CmpInst::Predicate get_cmp_predicate(QuadOp op, std::shared_ptr<Type> operand_type)
+{
+    return operand_type->is_floating() ? get_fcmp_predicate(op) : get_icmp_predicate(op, operand_type->is_unsigned);
+}
+
+/**
+ * Converts a value to an i1 that is true when the value is not zero.
+ */
+static llvm::Value *codegen_is_true(llvm::Value *value, CodegenContext& context)
+{
+    if (value->getType()->isFloatingPointTy())
+    {
+        return context.llvm_builder->CreateFCmpUNE(value, llvm::ConstantFP::get(value->getType(), 0.0));
+    }
+
+    return context.llvm_builder->CreateICmpNE(value, llvm::ConstantInt::get(value->getType(), 0));
+}
+
+/**
+ * Generates LLVM code that converts a value between arithmetic types.
+ */
+static llvm::Value *codegen_conversion(llvm::Value *value, std::shared_ptr<Type> from, std::shared_ptr<Type> to, CodegenContext& context)
+{
+    auto llvm_type = get_llvm_type(to, context);
+    if (from->is_floating() && to->is_floating())
+    {
+        return context.llvm_builder->CreateFPCast(value, llvm_type);
+    }
+    else if (from->is_floating())
+    {
+        return to->is_unsigned ? context.llvm_builder->CreateFPToUI(value, llvm_type) : context.llvm_builder->CreateFPToSI(value, llvm_type);
+    }
+    else if (to->is_floating())
+    {
+        return from->is_unsigned ? context.llvm_builder->CreateUIToFP(value, llvm_type) : context.llvm_builder->CreateSIToFP(value, llvm_type);
+    }
+
+    return context.llvm_builder->CreateIntCast(value, llvm_type, !from->is_unsigned);
+}
+
+/**
+ * Determines if arithmetic in the type is signed int or long arithmetic, whose overflow is undefined in C. Smaller
+ * types are promoted to int before arithmetic, so their overflow wraps when the result is converted back.
+ */
+static bool has_undefined_overflow(std::shared_ptr<Type> type)
+{
+    auto scalar_type = type->type == TypeType::Vector ? type->elem_type : type;
+    return (scalar_type->type == TypeType::Int || scalar_type->type == TypeType::Long) && !scalar_type->is_unsigned;
+}
+
 /**
  * Generates LLVM code for a binary instruction.
  */
@@ -200,33 +426,94 @@ static llvm::Value *codegen_binop(std::shared_ptr<Quad> quad, CodegenContext& co
 {
     assert(quad->res->type == OperandType::Variable);
 
-    auto arg1 = codegen(quad->arg1, context);
-    auto arg2 = codegen(quad->arg2, context);
+    auto operand_type = get_operand_type(quad);
+    auto llvm_operand_type = get_llvm_type(operand_type, context);
+    auto arg1 = codegen(quad->arg1, context, llvm_operand_type);
+    auto arg2 = codegen(quad->arg2, context, llvm_operand_type);
+    auto nsw = has_undefined_overflow(operand_type) && !quad->wraps;
 
     llvm::Value *res;
     switch (quad->op)
     {
         case QuadOp::Add:
-            res = context.llvm_builder->CreateAdd(arg1, arg2);
+            res = context.llvm_builder->CreateAdd(arg1, arg2, "", false, nsw);
             break;
         case QuadOp::Sub:
-            res = context.llvm_builder->CreateSub(arg1, arg2);
+            res = context.llvm_builder->CreateSub(arg1, arg2, "", false, nsw);
             break;
         case QuadOp::Mul:
-            res = context.llvm_builder->CreateMul(arg1, arg2);
+            res = context.llvm_builder->CreateMul(arg1, arg2, "", false, nsw);
             break;
         case QuadOp::Div:
-            // TODO if types are unsigned, need to use UDiv
-            res = context.llvm_builder->CreateSDiv(arg1, arg2);
+            res = operand_type->is_unsigned ? context.llvm_builder->CreateUDiv(arg1, arg2) : context.llvm_builder->CreateSDiv(arg1, arg2);
             break;
         case QuadOp::Mod:
-            // TODO if types are unsigned, need to use URem
-            res = context.llvm_builder->CreateSRem(arg1, arg2);
+            res = operand_type->is_unsigned ? context.llvm_builder->CreateURem(arg1, arg2) : context.llvm_builder->CreateSRem(arg1, arg2);
+            break;
+        case QuadOp::Eq:
+        case QuadOp::Neq:
+        case QuadOp::Lt:
+        case QuadOp::Leq:
+        case QuadOp::Gt:
+        case QuadOp::Geq:
+            res = context.llvm_builder->CreateCmp(get_cmp_predicate(quad->op, operand_type), arg1, arg2);
+            break;
+        case QuadOp::And:
+            // both operands are already evaluated, so this is a select rather than a branch
+            res = context.llvm_builder->CreateLogicalAnd(codegen_is_true(arg1, context), codegen_is_true(arg2, context));
+            break;
+        case QuadOp::Or:
+            res = context.llvm_builder->CreateLogicalOr(codegen_is_true(arg1, context), codegen_is_true(arg2, context));
+            break;
+        case QuadOp::BitAnd:
+            res = context.llvm_builder->CreateAnd(arg1, arg2);
+            break;
+        case QuadOp::BitOr:
+            res = context.llvm_builder->CreateOr(arg1, arg2);
+            break;
+        case QuadOp::BitXor:
+            res = context.llvm_builder->CreateXor(arg1, arg2);
+            break;
+        case QuadOp::Shl:
+            res = context.llvm_builder->CreateShl(arg1, arg2);
+            break;
+        case QuadOp::Shr:
+            res = operand_type->is_unsigned ? context.llvm_builder->CreateLShr(arg1, arg2) : context.llvm_builder->CreateAShr(arg1, arg2);
+            break;
+        case QuadOp::FAdd:
+            res = context.llvm_builder->CreateFAdd(arg1, arg2);
+            break;
+        case QuadOp::FSub:
+            res = context.llvm_builder->CreateFSub(arg1, arg2);
+            break;
+        case QuadOp::FMul:
+            res = context.llvm_builder->CreateFMul(arg1, arg2);
+            break;
+        case QuadOp::FDiv:
+            res = context.llvm_builder->CreateFDiv(arg1, arg2);
             break;
+        case QuadOp::MulHi:
+        {
+            // multiply in double the width and keep the high half
+            auto width = arg1->getType()->getIntegerBitWidth();
+            auto wide_type = llvm::IntegerType::get(*context.llvm_context, width * 2);
+            auto wide_arg1 = context.llvm_builder->CreateIntCast(arg1, wide_type, !operand_type->is_unsigned);
+            auto wide_arg2 = context.llvm_builder->CreateIntCast(arg2, wide_type, !operand_type->is_unsigned);
+            auto product = context.llvm_builder->CreateMul(wide_arg1, wide_arg2);
+            auto high = context.llvm_builder->CreateLShr(product, llvm::ConstantInt::get(wide_type, width));
+            res = context.llvm_builder->CreateTrunc(high, arg1->getType());
+            break;
+        }
         default:
             break;
     }
 
+    if (res->getType()->isIntegerTy(1))
+    {
+        // booleans are materialized as 0 or 1 in the type of the result
+        res = context.llvm_builder->CreateZExt(res, get_llvm_type(quad->res->symbol->type, context));
+    }
+
     store(quad->res->symbol, res, context);
     return res;
 }
@@ -238,23 +525,55 @@ static llvm::Value *codegen_unop(std::shared_ptr<Quad> quad, CodegenContext& con
 {
     assert(quad->res->type == OperandType::Variable);
 
-    auto arg1 = codegen(quad->arg1, context);
+    auto operand_type = get_operand_type(quad);
+    auto arg1 = codegen(quad->arg1, context, get_llvm_type(operand_type, context));
 
     llvm::Value *res;
     switch (quad->op)
     {
         case QuadOp::Neg:
-            res = context.llvm_builder->CreateNeg(arg1);
+            res = context.llvm_builder->CreateNeg(arg1, "", false, has_undefined_overflow(operand_type) && !quad->wraps);
+            break;
+        case QuadOp::FNeg:
+            res = context.llvm_builder->CreateFNeg(arg1);
+            break;
+        case QuadOp::Not:
+        {
+            auto is_false = context.llvm_builder->CreateNot(codegen_is_true(arg1, context));
+            res = context.llvm_builder->CreateZExt(is_false, get_llvm_type(quad->res->symbol->type, context));
+            break;
+        }
+        case QuadOp::BitNot:
+            res = context.llvm_builder->CreateNot(arg1);
             break;
         case QuadOp::RDeref:
             assert(quad->arg1->type == OperandType::Variable);
-            res = context.llvm_builder->CreateLoad(get_llvm_type(quad->arg1->symbol->type->elem_type, context), arg1);
+            if (quad->res->symbol->type->type == TypeType::Vector)
+            {
+                // vectors are loaded from consecutive array elements, so they are only aligned to the element
+                auto align = llvm::Align(quad->arg1->symbol->type->elem_type->size());
+                res = add_tbaa(context.llvm_builder->CreateAlignedLoad(get_llvm_type(quad->res->symbol->type, context), arg1, align), quad->res->symbol->type, context);
+            }
+            else
+            {
+                res = add_tbaa(context.llvm_builder->CreateLoad(get_llvm_type(quad->arg1->symbol->type->elem_type, context), arg1), quad->arg1->symbol->type->elem_type, context);
+            }
             break;
         case QuadOp::AddrOf:
             break; // TODO
         case QuadOp::Copy:
             res = arg1;
             break;
+        case QuadOp::Cast:
+            res = codegen_conversion(arg1, operand_type, quad->res->symbol->type, context);
+            break;
+        case QuadOp::Splat:
+        {
+            // constants are already splatted by the vector type hint
+            auto vector_type = llvm::cast<llvm::FixedVectorType>(get_llvm_type(quad->res->symbol->type, context));
+            res = arg1->getType()->isVectorTy() ? arg1 : context.llvm_builder->CreateVectorSplat(vector_type->getNumElements(), arg1);
+            break;
+        }
         default:
             break;
     }
@@ -268,25 +587,84 @@ static llvm::Value *codegen_unop(std::shared_ptr<Quad> quad, CodegenContext& con
  */
 static llvm::Value *codegen_lderef(std::shared_ptr<Quad> quad, CodegenContext& context)
 {
-    auto arg1 = codegen(quad->arg1, context);
+    auto arg1 = codegen(quad->arg1, context, get_llvm_type(quad->res->symbol->type->elem_type, context));
     auto res = codegen(quad->res, context);
-    return context.llvm_builder->CreateStore(arg1, res);
+    auto elem_type = quad->res->symbol->type->elem_type;
+    if (arg1->getType()->isVectorTy())
+    {
+        return add_tbaa(context.llvm_builder->CreateAlignedStore(arg1, res, llvm::Align(elem_type->size())), elem_type, context);
+    }
+
+    return add_tbaa(context.llvm_builder->CreateStore(arg1, res), elem_type, context);
+}
+
+/**
+ * Generates LLVM code for an array index, widened to 64 bits from the signedness of its type, so that a negative or
+ * large unsigned index is not wrapped.
+ */
+static llvm::Value *codegen_index(std::shared_ptr<Operand> operand, CodegenContext& context)
+{
+    auto index = codegen(operand, context, context.llvm_builder->getInt64Ty());
+    if (index->getType() != context.llvm_builder->getInt64Ty())
+    {
+        auto is_unsigned = operand->type == OperandType::Variable && operand->symbol->type->is_unsigned;
+        index = is_unsigned ? context.llvm_builder->CreateZExt(index, context.llvm_builder->getInt64Ty()) : context.llvm_builder->CreateSExt(index, context.llvm_builder->getInt64Ty());
+    }
+
+    return index;
 }
 
 /**
- * Generates LLVM code for an add pointer instruction.
+ * Generates LLVM code for an add pointer instruction. The address is an inbounds GEP over the element type, or over the
+ * array type for arrays of known size, so that LLVM knows what is indexed and that the address stays in the array.
  */
 static llvm::Value *codegen_addptr(std::shared_ptr<Quad> quad, CodegenContext& context)
 {
     auto arg1 = codegen(quad->arg1, context);
-    auto arg2 = codegen(quad->arg2, context);
-    auto multiplier = llvm::ConstantInt::get(arg2->getType(), 2);
-    auto offset = context.llvm_builder->CreateShl(arg2, multiplier);
-    auto res = context.llvm_builder->CreatePtrAdd(arg1, offset);
+    auto index = codegen_index(quad->arg2, context);
+
+    llvm::Value *res;
+    auto array_type = quad->arg1->symbol->type;
+    if (array_type->type == TypeType::Array && array_type->num_elems)
+    {
+        res = context.llvm_builder->CreateInBoundsGEP(get_llvm_type(array_type, context), arg1, { context.llvm_builder->getInt64(0), index });
+    }
+    else
+    {
+        res = context.llvm_builder->CreateInBoundsGEP(get_llvm_type(quad->res->symbol->type->elem_type, context), arg1, index);
+    }
+
     store(quad->res->symbol, res, context);
     return res;
 }
 
+/**
+ * Generates LLVM code for a bounds check instruction. The index is widened to 64 bits as for an access and compared as
+ * unsigned, so a negative index fails too, and the failing branch is marked as unlikely so that the check costs little
+ * in hot code.
+ */
+static llvm::Value *codegen_check(std::shared_ptr<Quad> quad, CodegenContext& context)
+{
+    auto index = codegen_index(quad->arg1, context);
+    auto size = codegen(quad->arg2, context, context.llvm_builder->getInt64Ty());
+    auto fails = context.llvm_builder->CreateICmpUGE(index, size);
+
+    // the check splits the block, and the rest of the block falls through to the next block as before
+    auto next_block = context.llvm_block->getNextNode();
+    auto trap_block = llvm::BasicBlock::Create(*context.llvm_context, "", context.llvm_function, next_block);
+    auto ok_block = llvm::BasicBlock::Create(*context.llvm_context, "", context.llvm_function, next_block);
+    auto weights = llvm::MDBuilder(*context.llvm_context).createBranchWeights(1, (1 << 20) - 1);
+    auto res = context.llvm_builder->CreateCondBr(fails, trap_block, ok_block, weights);
+
+    context.llvm_builder->SetInsertPoint(trap_block);
+    context.llvm_builder->CreateCall(llvm::Intrinsic::getDeclaration(context.llvm_module.get(), llvm::Intrinsic::trap));
+    context.llvm_builder->CreateUnreachable();
+
+    context.llvm_block = ok_block;
+    context.llvm_builder->SetInsertPoint(ok_block);
+    return res;
+}
+
 /**
  * Generates LLVM code for a return instruction.
  */
@@ -298,7 +676,8 @@ static llvm::Value *codegen_return(std::shared_ptr<Quad> quad, CodegenContext& c
     }
     else
     {
-        auto arg1 = codegen(quad->arg1, context);
+        auto ret_type = context.function_def->function->type->ret_type;
+        auto arg1 = codegen(quad->arg1, context, get_llvm_type(ret_type, context));
         return context.llvm_builder->CreateRet(arg1);
     }
 }
@@ -318,39 +697,38 @@ static llvm::Value *codegen_goto(std::shared_ptr<Quad> quad, CodegenContext& con
  */
 static llvm::Value *codegen_if(std::shared_ptr<Quad> quad, CodegenContext& context)
 {
-    auto arg1 = codegen(quad->arg1, context);
-    auto arg2 = codegen(quad->arg2, context);
+    auto operand_type = get_operand_type(quad);
+    auto arg1 = codegen(quad->arg1, context, get_llvm_type(operand_type, context));
+    auto arg2 = codegen(quad->arg2, context, get_llvm_type(operand_type, context));
 
-    llvm::Value *cond;
-    switch (quad->op)
-    {
-        case QuadOp::IfEq:
-            cond = context.llvm_builder->CreateCmp(llvm::CmpInst::Predicate::ICMP_EQ, arg1, arg2);
-            break;
-        case QuadOp::IfNeq:
-            cond = context.llvm_builder->CreateCmp(llvm::CmpInst::Predicate::ICMP_NE, arg1, arg2);
-            break;
-        case QuadOp::IfLt:
-            cond = context.llvm_builder->CreateCmp(llvm::CmpInst::Predicate::ICMP_SLT, arg1, arg2);
-            break;
-        case QuadOp::IfLeq:
-            cond = context.llvm_builder->CreateCmp(llvm::CmpInst::Predicate::ICMP_SLE, arg1, arg2);
-            break;
-        case QuadOp::IfGt:
-            cond = context.llvm_builder->CreateCmp(llvm::CmpInst::Predicate::ICMP_SGT, arg1, arg2);
-            break;
-        case QuadOp::IfGeq:
-            cond = context.llvm_builder->CreateCmp(llvm::CmpInst::Predicate::ICMP_SGE, arg1, arg2);
-            break;
-        default:
-            assert(false && "shouldn't get here");
-    }
+    auto cond = context.llvm_builder->CreateCmp(get_cmp_predicate(quad->op, operand_type), arg1, arg2);
 
     auto true_block = context.block_map[quad->res];
     auto false_block = context.llvm_block->getNextNode();
     return context.llvm_builder->CreateCondBr(cond, true_block, false_block);
 }
 
+/**
+ * Generates LLVM code for a switch instruction.
+ * LLVM lowers the switch to a jump table when the cases are dense, and to a balanced binary search otherwise.
+ */
+static llvm::Value *codegen_switch(std::shared_ptr<Quad> quad, CodegenContext& context)
+{
+    auto arg1 = codegen(quad->arg1, context);
+    assert(context.block_map.find(quad->res) != context.block_map.end());
+
+    auto default_block = context.block_map[quad->res];
+    auto switch_inst = context.llvm_builder->CreateSwitch(arg1, default_block, quad->cases.size());
+    for (auto& c : quad->cases)
+    {
+        assert(context.block_map.find(c.second) != context.block_map.end());
+        auto value = llvm::ConstantInt::get(llvm::cast<llvm::IntegerType>(arg1->getType()), c.first, true);
+        switch_inst->addCase(value, context.block_map[c.second]);
+    }
+
+    return switch_inst;
+}
+
 /**
  * Generates LLVM code for an instruction.
  */
@@ -366,17 +744,42 @@ static llvm::Value *codegen(std::shared_ptr<Quad> quad, CodegenContext& context)
         case QuadOp::Mul:
         case QuadOp::Div:
         case QuadOp::Mod:
+        case QuadOp::Eq:
+        case QuadOp::Neq:
+        case QuadOp::Lt:
+        case QuadOp::Leq:
+        case QuadOp::Gt:
+        case QuadOp::Geq:
+        case QuadOp::And:
+        case QuadOp::Or:
+        case QuadOp::BitAnd:
+        case QuadOp::BitOr:
+        case QuadOp::BitXor:
+        case QuadOp::Shl:
+        case QuadOp::Shr:
+        case QuadOp::MulHi:
+        case QuadOp::FAdd:
+        case QuadOp::FSub:
+        case QuadOp::FMul:
+        case QuadOp::FDiv:
             return codegen_binop(quad, context);
         case QuadOp::Neg:
+        case QuadOp::FNeg:
+        case QuadOp::Not:
+        case QuadOp::BitNot:
         case QuadOp::RDeref:
         case QuadOp::AddrOf:
         case QuadOp::Copy:
+        case QuadOp::Cast:
+        case QuadOp::Splat:
             return codegen_unop(quad, context);
         case QuadOp::LDeref:
             return codegen_lderef(quad, context);
         case QuadOp::AddPtr:
             return codegen_addptr(quad, context);
             break; // TODO
+        case QuadOp::Check:
+            return codegen_check(quad, context);
         case QuadOp::Goto:
             return codegen_goto(quad, context);
         case QuadOp::IfEq:
@@ -386,6 +789,8 @@ static llvm::Value *codegen(std::shared_ptr<Quad> quad, CodegenContext& context)
         case QuadOp::IfGt:
         case QuadOp::IfGeq:
             return codegen_if(quad, context);
+        case QuadOp::Switch:
+            return codegen_switch(quad, context);
         case QuadOp::Return:
             return codegen_return(quad, context);
         case QuadOp::Param:
@@ -440,6 +845,45 @@ static llvm::Value *codegen(std::shared_ptr<BasicBlock> block, CodegenContext& c
     return context.llvm_block;
 }
 
+/**
+ * Gives the LLVM function the attributes inferred for the function and the restrict parameters.
+ */
+void codegen_attributes(llvm::Function *llvm_function, std::shared_ptr<FunctionDef> def)
+{
+    auto& attributes = def->attributes;
+    if (attributes.readnone)
+    {
+        llvm_function->setDoesNotAccessMemory();
+    }
+    else if (attributes.readonly)
+    {
+        llvm_function->setOnlyReadsMemory();
+    }
+
+    if (attributes.nounwind)
+    {
+        llvm_function->setDoesNotThrow();
+    }
+
+    if (attributes.norecurse)
+    {
+        llvm_function->setDoesNotRecurse();
+    }
+
+    if (attributes.willreturn)
+    {
+        llvm_function->setWillReturn();
+    }
+
+    for (auto i = 0; i < def->params.size(); i++)
+    {
+        if (def->params[i]->type->is_restrict || attributes.noalias.find(i) != attributes.noalias.end())
+        {
+            llvm_function->addParamAttr(i, llvm::Attribute::NoAlias);
+        }
+    }
+}
+
 /**
  * Generates LLVM code for a function prototype.
  */
@@ -453,28 +897,31 @@ static llvm::Function *codegen_prototype(std::shared_ptr<FunctionDef> def, Codeg
 
     auto llvm_return_type = get_llvm_type(def->function->type->ret_type, context);
     auto llvm_function_type = llvm::FunctionType::get(llvm_return_type, llvm_param_types, false);
-    auto llvm_function = llvm::Function::Create(llvm_function_type, llvm::Function::ExternalLinkage, def->function->get_name(), context.llvm_module.get());
+    auto linkage = def->attributes.internal ? llvm::Function::InternalLinkage : llvm::Function::ExternalLinkage;
+    auto llvm_function = llvm::Function::Create(llvm_function_type, linkage, def->function->get_name(), context.llvm_module.get());
+    codegen_attributes(llvm_function, def);
     return llvm_function;
 }
 
 /**
  * Generates LLVM code for a function.
  */
-static llvm::Function *codegen(std::shared_ptr<FunctionDef> def, CodegenContext& context)
+static llvm::Function *codegen(std::shared_ptr<FunctionDef> def, CodegenContext& context, bool declare_only)
 {
     context.function_def = def;
 
-    if (def->is_proto())
+    auto llvm_function = context.llvm_module->getFunction(def->function->get_name());
+    if (def->is_proto() || declare_only)
     {
-        return codegen_prototype(def, context);
+        return llvm_function != nullptr ? llvm_function : codegen_prototype(def, context);
     }
 
-    auto llvm_function = context.llvm_module->getFunction(def->function->get_name());
     if (llvm_function == nullptr)
     {
         llvm_function = codegen_prototype(def, context); 
     }
 
+    llvm::TimeTraceScope trace("codegen function", def->function->get_name());
     context.llvm_function = llvm_function;
 
     // create an LLVM block for each block in the CFG
@@ -515,14 +962,18 @@ static llvm::Function *codegen(std::shared_ptr<FunctionDef> def, CodegenContext&
 /**
  * Generates LLVM code for a global variable.
  */
-static llvm::GlobalVariable *codegen_global(std::shared_ptr<GlobalDeclaration> global_decl, CodegenContext& context)
+static llvm::GlobalVariable *codegen_global(std::shared_ptr<GlobalDeclaration> global_decl, CodegenContext& context, const Options& options)
 {
+    // when the whole program is visible no other module can refer to the global, so it is internal to this one
+    // the type of the symbol is the array type when the global is an array, while the declared type is its element type
+    auto linkage = options.whole_program ? llvm::GlobalValue::LinkageTypes::InternalLinkage : llvm::GlobalValue::LinkageTypes::CommonLinkage;
+    auto type = global_decl->symbol->type;
     auto llvm_global = new llvm::GlobalVariable(
         *context.llvm_module.get(),
-        get_llvm_type(global_decl->type, context),
+        get_llvm_type(type, context),
         false /* isConstant */, 
-        llvm::GlobalValue::LinkageTypes::CommonLinkage,
-        get_default_value(global_decl->type, context),
+        linkage,
+        get_default_value(type, context),
         global_decl->symbol->get_name());
 
     global_decl->symbol->symbol_data.value = llvm_global;
@@ -530,26 +981,45 @@ static llvm::GlobalVariable *codegen_global(std::shared_ptr<GlobalDeclaration> g
 }
 
 /**
- * Generates LLVM code for the program.
+ * Generates an LLVM module for the program in the given LLVM context. The functions in declare_only are only
+ * declared, e.g. because their code comes from the compile cache.
  */
-void codegen(std::shared_ptr<Program> program, std::ostream *file)
+std::unique_ptr<llvm::Module> codegen(std::shared_ptr<Program> program, llvm::LLVMContext& llvm_context, const Options& options, const std::set<FunctionDef *>& declare_only)
 {
-    CodegenContext context;
+    CodegenContext context(llvm_context);
+    if (options.fast_math)
+    {
+        // every floating point instruction created from now on may be reassociated, contracted, etc.
+        llvm::FastMathFlags flags;
+        flags.setFast();
+        context.llvm_builder->setFastMathFlags(flags);
+    }
 
     std::vector<llvm::GlobalVariable *> llvm_globals;
     for (auto global : program->globals)
     {
-        auto llvm_global = codegen_global(global, context);
+        auto llvm_global = codegen_global(global, context, options);
         llvm_globals.push_back(llvm_global);
     }
 
     for (auto function : program->functions)
     {
-        codegen(function, context);
+        codegen(function, context, declare_only.find(function.get()) != declare_only.end());
         auto a = context.llvm_builder->getInt32(21);
         auto b = context.llvm_builder->getInt32(22);
     }
 
+    return std::move(context.llvm_module);
+}
+
+/**
+ * Generates LLVM code for the program.
+ */
+void codegen(std::shared_ptr<Program> program, std::ostream *file, const Options& options)
+{
+    llvm::LLVMContext llvm_context;
+    auto llvm_module = codegen(program, llvm_context, options);
+
     llvm::raw_os_ostream stream(*file);
-    context.llvm_module->print(stream, nullptr);
+    llvm_module->print(stream, nullptr);
 }
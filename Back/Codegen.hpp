@@ -1,8 +1,14 @@
 #pragma once
 
+#include <set>
 #include <iostream>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
 #include "SyntaxTree.hpp"
 #include "Quad.hpp"
 #include "CFG.hpp"
+#include "Options.hpp"
 
-void codegen(std::shared_ptr<Program> program, std::ostream *file);
+std::unique_ptr<llvm::Module> codegen(std::shared_ptr<Program> program, llvm::LLVMContext& llvm_context, const Options& options = Options(), const std::set<FunctionDef *>& declare_only = {});
+void codegen_attributes(llvm::Function *llvm_function, std::shared_ptr<FunctionDef> def);
+void codegen(std::shared_ptr<Program> program, std::ostream *file, const Options& options = Options());
@@ -1,8 +1,7 @@
 #include "CodegenContext.hpp"
 
-CodegenContext::CodegenContext()
+CodegenContext::CodegenContext(llvm::LLVMContext& llvm_context) : llvm_context(&llvm_context)
 {
-    llvm_context = std::make_unique<llvm::LLVMContext>();
-    llvm_builder = std::make_unique<llvm::IRBuilder<>>(*llvm_context);
-    llvm_module = std::make_unique<llvm::Module>("main_module", *llvm_context);
+    llvm_builder = std::make_unique<llvm::IRBuilder<>>(llvm_context);
+    llvm_module = std::make_unique<llvm::Module>("main_module", llvm_context);
 }
\ No newline at end of file
@@ -23,7 +23,7 @@
  */
 struct CodegenContext
 {
-    std::unique_ptr<llvm::LLVMContext> llvm_context;
+    llvm::LLVMContext *llvm_context;
     std::unique_ptr<llvm::IRBuilder<>> llvm_builder;
     std::unique_ptr<llvm::Module> llvm_module;
 
@@ -32,5 +32,6 @@ struct CodegenContext
     llvm::BasicBlock *llvm_block;
     std::map<std::shared_ptr<Operand>, llvm::BasicBlock *> block_map;
     std::vector<llvm::Value *> param_stack;
-    CodegenContext();
+    std::map<TypeType, llvm::MDNode *> tbaa_tags;
+    CodegenContext(llvm::LLVMContext& llvm_context);
 };
\ No newline at end of file
@@ -0,0 +1,467 @@
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <cstring>
+#include <unistd.h>
+#include <link.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+#include "CallGraph.hpp"
+#include "Fingerprint.hpp"
+#include "Codegen.hpp"
+#include "CompileCache.hpp"
+
+namespace fs = std::filesystem;
+
+const std::string entry_extension = ".bc";
+
+// the named metadata that holds the effects of a cached function, which attribute inference needs
+const std::string effects_metadata = "acc.effects";
+
+static std::string hash(llvm::ArrayRef<uint8_t> data)
+{
+    return llvm::toHex(llvm::SHA256::hash(data), true);
+}
+
+/**
+ * Reads the GNU build id that the linker put in the notes of the executable, or returns an empty string if it has none.
+ */
+static std::string read_build_id()
+{
+    std::string build_id;
+    dl_iterate_phdr([](dl_phdr_info *info, size_t, void *data)
+    {
+        for (auto i = 0; i < info->dlpi_phnum; i++)
+        {
+            auto& header = info->dlpi_phdr[i];
+            if (header.p_type != PT_NOTE)
+            {
+                continue;
+            }
+
+            auto align = header.p_align == 8 ? 8 : 4;
+            auto note = (const char *)(info->dlpi_addr + header.p_vaddr);
+            auto end = note + header.p_memsz;
+            while (note + sizeof(ElfW(Nhdr)) <= end)
+            {
+                auto note_header = (const ElfW(Nhdr) *)note;
+                auto name = note + sizeof(ElfW(Nhdr));
+                auto desc = name + llvm::alignTo(note_header->n_namesz, align);
+                if (note_header->n_type == NT_GNU_BUILD_ID && note_header->n_namesz == 4 && memcmp(name, "GNU", 4) == 0)
+                {
+                    *(std::string *)data = hash(llvm::ArrayRef<uint8_t>((const uint8_t *)desc, note_header->n_descsz));
+                    return 1;
+                }
+
+                note = desc + llvm::alignTo(note_header->n_descsz, align);
+            }
+        }
+
+        // the first object is the executable, and the libraries after it do not matter
+        return 1;
+    }, &build_id);
+
+    return build_id;
+}
+
+/**
+ * Gets what identifies the build of the compiler, so that rebuilding it invalidates the cache even if the version
+ * did not change. This is the build id if it was linked with one, or else a hash of the executable.
+ */
+static const std::string& get_build_id()
+{
+    static const std::string build_id = []()
+    {
+        auto build_id = read_build_id();
+        if (build_id.empty())
+        {
+            auto path = llvm::sys::fs::getMainExecutable(nullptr, (void *)&read_build_id);
+            auto buffer = llvm::MemoryBuffer::getFile(path);
+            build_id = buffer ? hash(llvm::arrayRefFromStringRef((*buffer)->getBuffer())) : "";
+        }
+
+        return build_id;
+    }();
+
+    return build_id;
+}
+
+/**
+ * Gets the key of the compilation of the source, which is the hex SHA-256 of everything that affects its output.
+ */
+std::string CompileCache::get_key(const std::string& source, const std::string& version, const Options& options)
+{
+    auto data = version + '\0' + get_build_id() + '\0' + options.key() + '\0' + source;
+    return hash(llvm::arrayRefFromStringRef(data));
+}
+
+std::string CompileCache::get_entry_path(const std::string& key) const
+{
+    return directory + "/" + key + entry_extension;
+}
+
+std::string CompileCache::get_stats_path() const
+{
+    return directory + "/stats";
+}
+
+/**
+ * Loads the module cached for the key, or returns nullptr if there is none. A hit marks the entry as recently used.
+ */
+std::unique_ptr<llvm::Module> CompileCache::load(const std::string& key, llvm::LLVMContext& llvm_context)
+{
+    auto path = get_entry_path(key);
+    std::error_code error_code;
+    if (!fs::exists(path, error_code))
+    {
+        misses++;
+        return nullptr;
+    }
+
+    llvm::SMDiagnostic diagnostic;
+    auto module = llvm::parseIRFile(path, diagnostic, llvm_context);
+    if (module == nullptr)
+    {
+        // the entry is corrupt, e.g. it was written by a different LLVM, so it is replaced after compiling
+        fs::remove(path, error_code);
+        misses++;
+        return nullptr;
+    }
+
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error_code);
+    hits++;
+    return module;
+}
+
+/**
+ * Stores the module for the key, then evicts entries if the cache is too big. The entry is written to a temporary
+ * file and renamed into place, so other compilers sharing the cache never load a partly written entry. The cache
+ * only saves time, so an entry that can not be written is skipped rather than failing the compilation.
+ */
+void CompileCache::store(const std::string& key, llvm::Module& module)
+{
+    std::error_code error_code;
+    fs::create_directories(directory, error_code);
+
+    auto path = get_entry_path(key);
+    auto temp_path = path + ".tmp" + std::to_string(getpid());
+    {
+        llvm::raw_fd_ostream stream(temp_path, error_code, llvm::sys::fs::OF_None);
+        if (error_code)
+        {
+            return;
+        }
+
+        llvm::WriteBitcodeToFile(module, stream);
+        stream.close();
+        if (stream.has_error())
+        {
+            stream.clear_error();
+            fs::remove(temp_path, error_code);
+            return;
+        }
+    }
+
+    fs::rename(temp_path, path, error_code);
+    if (error_code)
+    {
+        fs::remove(temp_path, error_code);
+        return;
+    }
+
+    evict();
+}
+
+/**
+ * An entry of the cache, as it was when the directory was listed.
+ */
+struct CacheEntry
+{
+    fs::path path;
+    std::uintmax_t size;
+    fs::file_time_type last_used;
+};
+
+/**
+ * Lists the entries in the directory. Other compilers sharing the cache may remove entries while they are listed,
+ * so the entries that vanish are skipped, and a directory that can not be read has no entries.
+ */
+static std::vector<CacheEntry> list_entries(const std::string& directory)
+{
+    std::vector<CacheEntry> entries;
+    std::error_code error_code;
+    for (fs::directory_iterator it(directory, error_code), end; !error_code && it != end; it.increment(error_code))
+    {
+        std::error_code entry_error;
+        if (it->path().extension() != entry_extension || !it->is_regular_file(entry_error))
+        {
+            continue;
+        }
+
+        CacheEntry entry = { it->path(), it->file_size(entry_error), {} };
+        entry.last_used = entry_error ? entry.last_used : it->last_write_time(entry_error);
+        if (!entry_error)
+        {
+            entries.push_back(entry);
+        }
+    }
+
+    return entries;
+}
+
+/**
+ * Removes the least recently used entries until the entries fit in the maximum size.
+ */
+void CompileCache::evict()
+{
+    auto entries = list_entries(directory);
+    std::uintmax_t size = 0;
+    for (auto& entry : entries)
+    {
+        size += entry.size;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) { return a.last_used < b.last_used; });
+    for (auto& entry : entries)
+    {
+        if (size <= max_size)
+        {
+            break;
+        }
+
+        // an entry that another compiler removed first no longer takes up space either
+        std::error_code error_code;
+        size -= entry.size;
+        if (fs::remove(entry.path, error_code))
+        {
+            evictions++;
+        }
+    }
+}
+
+/**
+ * Declares the globals and functions that a function refers to in the module it is extracted into.
+ */
+struct DeclarationMaterializer : llvm::ValueMaterializer
+{
+    llvm::Module& module;
+
+    DeclarationMaterializer(llvm::Module& module) : module(module) {}
+
+    llvm::Value *materialize(llvm::Value *value) override
+    {
+        if (auto function = llvm::dyn_cast<llvm::Function>(value))
+        {
+            return module.getOrInsertFunction(function->getName(), function->getFunctionType()).getCallee();
+        }
+        else if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(value))
+        {
+            return module.getOrInsertGlobal(global->getName(), global->getValueType());
+        }
+
+        return nullptr;
+    }
+};
+
+/**
+ * Extracts the function into a module of its own, where what it refers to is declared, with its effects attached.
+ */
+static std::unique_ptr<llvm::Module> extract_function(llvm::Function *llvm_function, const Effects& effects)
+{
+    auto& llvm_context = llvm_function->getContext();
+    auto module = std::make_unique<llvm::Module>(llvm_function->getName(), llvm_context);
+    auto copy = llvm::Function::Create(llvm_function->getFunctionType(), llvm::Function::ExternalLinkage, llvm_function->getName(), module.get());
+
+    llvm::ValueToValueMapTy map;
+    for (auto i = 0; i < llvm_function->arg_size(); i++)
+    {
+        map[llvm_function->getArg(i)] = copy->getArg(i);
+    }
+
+    DeclarationMaterializer materializer(*module);
+    llvm::SmallVector<llvm::ReturnInst *, 4> returns;
+    llvm::CloneFunctionInto(copy, llvm_function, map, llvm::CloneFunctionChangeType::DifferentModule, returns, "", nullptr, nullptr, &materializer);
+    copy->setLinkage(llvm::Function::ExternalLinkage);
+
+    // cloning into another module adds a list of compile units, which is empty without debug info
+    auto compile_units = module->getNamedMetadata("llvm.dbg.cu");
+    if (compile_units != nullptr && compile_units->getNumOperands() == 0)
+    {
+        module->eraseNamedMetadata(compile_units);
+    }
+
+    std::vector<llvm::Metadata *> flags;
+    for (auto flag : { effects.reads, effects.writes, effects.calls_unknown, effects.may_not_return })
+    {
+        flags.push_back(llvm::ConstantAsMetadata::get(llvm::ConstantInt::getBool(llvm_context, flag)));
+    }
+
+    module->getOrInsertNamedMetadata(effects_metadata)->addOperand(llvm::MDNode::get(llvm_context, flags));
+    return module;
+}
+
+/**
+ * Reads the effects attached to a cached function, returning false if they are missing.
+ */
+static bool read_effects(llvm::Module& module, Effects& effects)
+{
+    auto metadata = module.getNamedMetadata(effects_metadata);
+    if (metadata == nullptr || metadata->getNumOperands() != 1 || metadata->getOperand(0)->getNumOperands() != 4)
+    {
+        return false;
+    }
+
+    auto node = metadata->getOperand(0);
+    auto flag = [&](int i) { return llvm::mdconst::extract<llvm::ConstantInt>(node->getOperand(i))->isOne(); };
+    effects.reads = flag(0);
+    effects.writes = flag(1);
+    effects.calls_unknown = flag(2);
+    effects.may_not_return = flag(3);
+    return true;
+}
+
+/**
+ * Looks up each defined function in the cache, after the interprocedural passes. The functions that are found have
+ * their effects set from the cache and are returned, so they are not optimized or generated again; their code is
+ * linked in by link_functions. The key of a function covers its quads and the signatures of what it calls.
+ */
+std::set<FunctionDef *> CompileCache::load_functions(std::vector<std::shared_ptr<FunctionDef>>& functions, const std::string& version, const Options& options, llvm::LLVMContext& llvm_context)
+{
+    function_keys.clear();
+    cached_functions.clear();
+
+    std::set<FunctionDef *> cached;
+    for (auto& [def, fingerprint] : FingerprintFunctions(functions))
+    {
+        auto key = get_key(fingerprint, version, options);
+        function_keys[def] = key;
+
+        Effects effects;
+        auto module = load(key, llvm_context);
+        if (module != nullptr && read_effects(*module, effects))
+        {
+            def->cached_effects = effects;
+            cached_functions[def] = std::move(module);
+            cached.insert(def);
+        }
+    }
+
+    return cached;
+}
+
+/**
+ * Stores the functions of the module that were not cached, then links in the code of those that were. The cached
+ * functions are given the attributes inferred for them in this compilation, since those depend on other functions.
+ */
+void CompileCache::link_functions(llvm::Module& module, std::vector<std::shared_ptr<FunctionDef>>& functions)
+{
+    CallGraph graph(functions);
+    for (auto& f : functions)
+    {
+        auto key = function_keys.find(f.get());
+        if (key != function_keys.end() && cached_functions.find(f.get()) == cached_functions.end())
+        {
+            auto llvm_function = module.getFunction(f->function->get_name());
+            store(key->second, *extract_function(llvm_function, FindDirectEffects(f, graph)));
+        }
+    }
+
+    // internal symbols can not be linked to, so they are made external until the cached functions are linked in
+    std::vector<std::string> internal;
+    for (auto& value : module.global_values())
+    {
+        if (value.hasInternalLinkage())
+        {
+            internal.push_back(value.getName().str());
+            value.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        }
+    }
+
+    llvm::Linker linker(module);
+    for (auto& [def, cached_module] : cached_functions)
+    {
+        if (linker.linkInModule(std::move(cached_module)))
+        {
+            throw std::runtime_error("could not link the cached code of " + def->function->get_name());
+        }
+    }
+
+    for (auto& name : internal)
+    {
+        module.getNamedValue(name)->setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+
+    for (auto& f : functions)
+    {
+        if (cached_functions.find(f.get()) != cached_functions.end())
+        {
+            auto llvm_function = module.getFunction(f->function->get_name());
+            llvm_function->setAttributes(llvm::AttributeList());
+            codegen_attributes(llvm_function, f);
+        }
+    }
+
+    if (auto metadata = module.getNamedMetadata(effects_metadata))
+    {
+        module.eraseNamedMetadata(metadata);
+    }
+
+    function_keys.clear();
+    cached_functions.clear();
+}
+
+/**
+ * Prints the statistics of this run and the totals of every run that used the directory.
+ */
+void CompileCache::print_stats(std::ostream& stream) const
+{
+    int total_hits = 0, total_misses = 0, total_evictions = 0;
+    std::ifstream stats(get_stats_path());
+    stats >> total_hits >> total_misses >> total_evictions;
+
+    std::uintmax_t size = 0;
+    auto entries = list_entries(directory);
+    for (auto& entry : entries)
+    {
+        size += entry.size;
+    }
+
+    stream << "cache: " << hits << " hits, " << misses << " misses, " << evictions << " evictions\n";
+    stream << "cache total: " << total_hits + hits << " hits, " << total_misses + misses << " misses, " << total_evictions + evictions << " evictions\n";
+    stream << "cache size: " << entries.size() << " entries, " << size << " of " << max_size << " bytes\n";
+}
+
+/**
+ * Adds the statistics of this run to the totals in the directory.
+ */
+CompileCache::~CompileCache()
+{
+    if (hits == 0 && misses == 0)
+    {
+        return;
+    }
+
+    int total_hits = 0, total_misses = 0, total_evictions = 0;
+    {
+        std::ifstream stats(get_stats_path());
+        stats >> total_hits >> total_misses >> total_evictions;
+    }
+
+    std::error_code error_code;
+    fs::create_directories(directory, error_code);
+    std::ofstream stats(get_stats_path());
+    stats << total_hits + hits << " " << total_misses + misses << " " << total_evictions + evictions << "\n";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include "SyntaxTree.hpp"
+#include "Options.hpp"
+
+/**
+ * A cache of the bitcode of compiled files, kept in a directory. An entry is keyed on a hash of the source, the
+ * compiler version and build and the options, so it is only used for exactly the same compilation. When the entries grow past
+ * the maximum size, the least recently used ones are evicted. Single functions can be cached too, so that only the
+ * functions that changed are optimized and generated again.
+ */
+class CompileCache
+{
+private:
+    std::string directory;
+    std::uintmax_t max_size;
+
+    // the statistics of this run, which are added to the totals kept in the directory when the cache is destroyed
+    int hits = 0;
+    int misses = 0;
+    int evictions = 0;
+
+    // the keys of the functions of the program being compiled, and the modules of those that were cached
+    std::map<FunctionDef *, std::string> function_keys;
+    std::map<FunctionDef *, std::unique_ptr<llvm::Module>> cached_functions;
+
+    std::string get_entry_path(const std::string& key) const;
+    std::string get_stats_path() const;
+    void evict();
+
+public:
+    CompileCache(const std::string& directory, std::uintmax_t max_size): directory(directory), max_size(max_size) {}
+    ~CompileCache();
+
+    static std::string get_key(const std::string& source, const std::string& version, const Options& options);
+
+    std::unique_ptr<llvm::Module> load(const std::string& key, llvm::LLVMContext& llvm_context);
+    void store(const std::string& key, llvm::Module& module);
+    std::set<FunctionDef *> load_functions(std::vector<std::shared_ptr<FunctionDef>>& functions, const std::string& version, const Options& options, llvm::LLVMContext& llvm_context);
+    void link_functions(llvm::Module& module, std::vector<std::shared_ptr<FunctionDef>>& functions);
+    void print_stats(std::ostream& stream) const;
+};
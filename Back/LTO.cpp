@@ -0,0 +1,176 @@
+#include <stdexcept>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/TargetParser/Host.h>
+#include <llvm/Transforms/IPO/Internalize.h>
+#include "LTO.hpp"
+
+/**
+ * Gets the target machine for the host, creating it the first time.
+ */
+llvm::TargetMachine& get_target_machine()
+{
+    static std::unique_ptr<llvm::TargetMachine> target_machine;
+    if (target_machine == nullptr)
+    {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        auto triple = llvm::sys::getDefaultTargetTriple();
+        std::string message;
+        auto target = llvm::TargetRegistry::lookupTarget(triple, message);
+        if (target == nullptr)
+        {
+            throw std::runtime_error(message);
+        }
+
+        target_machine.reset(target->createTargetMachine(triple, "generic", "", llvm::TargetOptions(), llvm::Reloc::PIC_));
+    }
+
+    return *target_machine;
+}
+
+/**
+ * Adds an event to the -ftime-trace trace for each LLVM pass that runs, with the function it runs on as the detail.
+ */
+static void trace_passes(llvm::PassInstrumentationCallbacks& callbacks)
+{
+    if (!llvm::timeTraceProfilerEnabled())
+    {
+        return;
+    }
+
+    callbacks.registerBeforeNonSkippedPassCallback([](llvm::StringRef pass, llvm::Any ir)
+    {
+        auto function = llvm::any_cast<const llvm::Function *>(&ir);
+        llvm::timeTraceProfilerBegin(pass, function != nullptr ? (*function)->getName() : "");
+    });
+    callbacks.registerAfterPassCallback([](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses&) { llvm::timeTraceProfilerEnd(); });
+    callbacks.registerAfterPassInvalidatedCallback([](llvm::StringRef, const llvm::PreservedAnalyses&) { llvm::timeTraceProfilerEnd(); });
+}
+
+/**
+ * Runs the pipeline on the module. The pre-link pipeline is run on each module before it is linked, like clang -flto
+ * does when it compiles a file, and the LTO pipeline is run once on the linked module.
+ */
+static void run_pipeline(llvm::Module& module, bool pre_link)
+{
+    llvm::LoopAnalysisManager loop_analyses;
+    llvm::FunctionAnalysisManager function_analyses;
+    llvm::CGSCCAnalysisManager cgscc_analyses;
+    llvm::ModuleAnalysisManager module_analyses;
+
+    llvm::PassInstrumentationCallbacks callbacks;
+    trace_passes(callbacks);
+
+    llvm::PassBuilder builder(&get_target_machine(), llvm::PipelineTuningOptions(), std::nullopt, &callbacks);
+    builder.registerModuleAnalyses(module_analyses);
+    builder.registerCGSCCAnalyses(cgscc_analyses);
+    builder.registerFunctionAnalyses(function_analyses);
+    builder.registerLoopAnalyses(loop_analyses);
+    builder.crossRegisterProxies(loop_analyses, function_analyses, cgscc_analyses, module_analyses);
+
+    auto pipeline = pre_link
+        ? builder.buildLTOPreLinkDefaultPipeline(llvm::OptimizationLevel::O2)
+        : builder.buildLTODefaultPipeline(llvm::OptimizationLevel::O2, nullptr);
+    pipeline.run(module, module_analyses);
+}
+
+/**
+ * Sets the triple and data layout of the module to those of the host.
+ */
+static void set_target(llvm::Module& module)
+{
+    auto& target_machine = get_target_machine();
+    module.setTargetTriple(target_machine.getTargetTriple().str());
+    module.setDataLayout(target_machine.createDataLayout());
+}
+
+/**
+ * Links the modules of the compiled files and the LLVM files, e.g. the test runtime, into one module, internalizes
+ * everything but main, and optimizes the whole program. The modules must all be in the given LLVM context.
+ */
+std::unique_ptr<llvm::Module> link_time_optimize(std::vector<std::unique_ptr<llvm::Module>> modules, const std::vector<std::string>& llvm_files, llvm::LLVMContext& llvm_context)
+{
+    for (auto& file : llvm_files)
+    {
+        llvm::SMDiagnostic diagnostic;
+        auto module = llvm::parseIRFile(file, diagnostic, llvm_context);
+        if (module == nullptr)
+        {
+            throw std::runtime_error(file + ": " + diagnostic.getMessage().str());
+        }
+
+        modules.push_back(std::move(module));
+    }
+
+    auto linked_module = std::make_unique<llvm::Module>("lto_module", llvm_context);
+    set_target(*linked_module);
+
+    llvm::Linker linker(*linked_module);
+    for (auto& module : modules)
+    {
+        set_target(*module);
+        run_pipeline(*module, true);
+
+        auto name = module->getModuleIdentifier();
+        if (linker.linkInModule(std::move(module)))
+        {
+            throw std::runtime_error("could not link " + name);
+        }
+    }
+
+    // nothing outside the program can call its functions or access its globals, so they can be inlined, removed, etc.
+    llvm::internalizeModule(*linked_module, [](const llvm::GlobalValue& value) { return value.getName() == "main"; });
+    run_pipeline(*linked_module, false);
+
+    return linked_module;
+}
+
+/**
+ * Emits a native object file for the module.
+ */
+void emit_object(llvm::Module& module, const std::string& path)
+{
+    std::error_code error_code;
+    llvm::raw_fd_ostream stream(path, error_code, llvm::sys::fs::OF_None);
+    if (error_code)
+    {
+        throw std::runtime_error("could not open " + path + ": " + error_code.message());
+    }
+
+    llvm::legacy::PassManager passes;
+    if (get_target_machine().addPassesToEmitFile(passes, stream, nullptr, llvm::CodeGenFileType::ObjectFile))
+    {
+        throw std::runtime_error("the target cannot emit object files");
+    }
+
+    passes.run(module);
+}
+
+
+/**
+ * Emits the module as an LLVM bitcode file.
+ */
+void emit_bitcode(llvm::Module& module, const std::string& path)
+{
+    std::error_code error_code;
+    llvm::raw_fd_ostream stream(path, error_code, llvm::sys::fs::OF_None);
+    if (error_code)
+    {
+        throw std::runtime_error("could not open " + path + ": " + error_code.message());
+    }
+
+    llvm::WriteBitcodeToFile(module, stream);
+}
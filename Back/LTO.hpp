@@ -0,0 +1,13 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+llvm::TargetMachine& get_target_machine();
+std::unique_ptr<llvm::Module> link_time_optimize(std::vector<std::unique_ptr<llvm::Module>> modules, const std::vector<std::string>& llvm_files, llvm::LLVMContext& llvm_context);
+void emit_object(llvm::Module& module, const std::string& path);
+void emit_bitcode(llvm::Module& module, const std::string& path);
@@ -0,0 +1,219 @@
+#include <set>
+#include <new>
+#include <atomic>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <sys/resource.h>
+#include "Report.hpp"
+
+// the number of allocations made through operator new, which is replaced below to count them
+static std::atomic<long> allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    if (auto memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+/**
+ * Gets the peak resident set size of the process in kilobytes.
+ */
+static long get_peak_rss_kb()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+PhaseTimer::PhaseTimer(Report *report, const std::string& phase) : report(report), phase(phase), trace(phase)
+{
+    wall_start = std::chrono::steady_clock::now();
+    cpu_start = std::clock();
+    if (report != nullptr)
+    {
+        report->start_phase();
+    }
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (report != nullptr)
+    {
+        std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - wall_start;
+        report->finish_phase(phase, wall.count(), 1000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC);
+    }
+}
+
+void Report::start_phase()
+{
+    nested_times.push_back({ 0, 0 });
+}
+
+/**
+ * Adds the time of the phase, less the time of the phases that ran within it, which is also added to the phase that
+ * it ran within.
+ */
+void Report::finish_phase(const std::string& phase, double wall_ms, double cpu_ms)
+{
+    auto [nested_wall_ms, nested_cpu_ms] = nested_times.back();
+    nested_times.pop_back();
+    if (!nested_times.empty())
+    {
+        nested_times.back().first += wall_ms;
+        nested_times.back().second += cpu_ms;
+    }
+
+    wall_ms -= nested_wall_ms;
+    cpu_ms -= nested_cpu_ms;
+
+    auto it = std::find_if(phases.begin(), phases.end(), [&](auto& p) { return p.name == phase; });
+    if (it == phases.end())
+    {
+        phases.push_back({ phase });
+        it = phases.end() - 1;
+    }
+
+    it->wall_ms += wall_ms;
+    it->cpu_ms += cpu_ms;
+}
+
+long& Report::get_count(const std::string& name)
+{
+    auto it = std::find_if(counts.begin(), counts.end(), [&](auto& c) { return c.first == name; });
+    if (it == counts.end())
+    {
+        counts.push_back({ name, 0 });
+        it = counts.end() - 1;
+    }
+
+    return it->second;
+}
+
+void Report::add_count(const std::string& name, long count)
+{
+    get_count(name) += count;
+}
+
+/**
+ * Counts the AST nodes created so far, and the functions, quads, temps and basic blocks of the program.
+ */
+void Report::count_program(std::shared_ptr<Program> program)
+{
+    get_count("ast nodes") = SyntaxTree::nodes_created;
+    for (auto& g : program->globals)
+    {
+        for (auto quad = g->ir_list.begin(); quad != g->ir_list.end(); quad = quad->next)
+        {
+            add_count("quads", 1);
+        }
+    }
+
+    for (auto& f : program->functions)
+    {
+        if (f->is_proto())
+        {
+            continue;
+        }
+
+        std::set<Symbol *> temps;
+        for (auto quad = f->ir_list.begin(); quad != f->ir_list.end(); quad = quad->next)
+        {
+            add_count("quads", 1);
+            auto def = quad->def();
+            if (def != nullptr && def->symbol->is_temp)
+            {
+                temps.insert(def->symbol.get());
+            }
+        }
+
+        add_count("functions", 1);
+        add_count("temps", temps.size());
+        add_count("basic blocks", f->cfg.size());
+    }
+}
+
+/**
+ * Prints the wall and CPU time of each phase and their total.
+ */
+void Report::print_time(std::ostream& stream) const
+{
+    double total_wall = 0, total_cpu = 0;
+    stream << "===== acc time report =====\n";
+    stream << std::left << std::setw(16) << "phase" << std::right << std::setw(14) << "wall (ms)" << std::setw(14) << "cpu (ms)" << "\n";
+    stream << std::fixed << std::setprecision(3);
+    for (auto& phase : phases)
+    {
+        stream << std::left << std::setw(16) << phase.name << std::right << std::setw(14) << phase.wall_ms << std::setw(14) << phase.cpu_ms << "\n";
+        total_wall += phase.wall_ms;
+        total_cpu += phase.cpu_ms;
+    }
+
+    stream << std::left << std::setw(16) << "total" << std::right << std::setw(14) << total_wall << std::setw(14) << total_cpu << "\n";
+    stream << std::defaultfloat << std::setprecision(6);
+}
+
+/**
+ * Prints the peak memory use, the number of allocations, and the counts of what was compiled.
+ */
+void Report::print_memory(std::ostream& stream) const
+{
+    stream << "===== acc memory report =====\n";
+    stream << std::left << std::setw(16) << "peak rss (kb)" << std::right << std::setw(14) << get_peak_rss_kb() << "\n";
+    stream << std::left << std::setw(16) << "allocations" << std::right << std::setw(14) << allocations << "\n";
+    for (auto& [name, count] : counts)
+    {
+        stream << std::left << std::setw(16) << name << std::right << std::setw(14) << count << "\n";
+    }
+}
+
+/**
+ * Writes the times, memory use and counts as JSON, e.g. { "phases": [ { "name": "lex", "wall_ms": 0.1,
+ * "cpu_ms": 0.1 } ], "memory": { "peak_rss_kb": 9000, "allocations": 1000 }, "counts": { "tokens": 100 } }.
+ */
+void Report::write_json(std::ostream& stream) const
+{
+    stream << "{\n  \"phases\": [";
+    for (auto i = 0; i < phases.size(); i++)
+    {
+        stream << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << phases[i].name << "\", \"wall_ms\": " << phases[i].wall_ms << ", \"cpu_ms\": " << phases[i].cpu_ms << " }";
+    }
+
+    stream << "\n  ],\n  \"memory\": { \"peak_rss_kb\": " << get_peak_rss_kb() << ", \"allocations\": " << allocations << " },\n  \"counts\": {";
+    for (auto i = 0; i < counts.size(); i++)
+    {
+        stream << (i == 0 ? " " : ", ") << "\"" << counts[i].first << "\": " << counts[i].second;
+    }
+
+    stream << " }\n}\n";
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <ctime>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <llvm/Support/TimeProfiler.h>
+#include "SyntaxTree.hpp"
+
+/**
+ * The time spent in each phase of the compiler and the size of what it worked on, for -ftime-report, -fmem-report
+ * and -freport-json. The times and counts of each file compiled are added together. A phase that runs within another
+ * one, e.g. loading cached functions while optimizing, is only counted for the inner phase, so the phases add up to
+ * the total.
+ */
+class Report
+{
+private:
+    struct Phase
+    {
+        std::string name;
+        double wall_ms = 0;
+        double cpu_ms = 0;
+    };
+
+    // in the order they first ran
+    std::vector<Phase> phases;
+    std::vector<std::pair<std::string, long>> counts;
+
+    // for each phase that is running, the wall and CPU time of the phases that ran within it
+    std::vector<std::pair<double, double>> nested_times;
+
+    long& get_count(const std::string& name);
+
+public:
+    void start_phase();
+    void finish_phase(const std::string& phase, double wall_ms, double cpu_ms);
+    void add_count(const std::string& name, long count);
+    void count_program(std::shared_ptr<Program> program);
+
+    void print_time(std::ostream& stream) const;
+    void print_memory(std::ostream& stream) const;
+    void write_json(std::ostream& stream) const;
+};
+
+/**
+ * Times a phase from when it is constructed to when it is destroyed, and adds the time to the report if there is one.
+ * The phase is also an event in the -ftime-trace trace.
+ */
+class PhaseTimer
+{
+private:
+    Report *report;
+    std::string phase;
+    std::chrono::steady_clock::time_point wall_start;
+    std::clock_t cpu_start;
+    llvm::TimeTraceScope trace;
+
+public:
+    PhaseTimer(Report *report, const std::string& phase);
+    ~PhaseTimer();
+};
+
+/**
+ * Runs the phase, timing it if there is a report, and returns what it returns.
+ */
+template <typename Function>
+auto time_phase(Report *report, const std::string& phase, Function function)
+{
+    PhaseTimer timer(report, phase);
+    return function();
+}
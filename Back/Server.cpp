@@ -0,0 +1,163 @@
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <iostream>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "LTO.hpp"
+#include "Server.hpp"
+
+/**
+ * Serves one request in a process forked from the server, which exits when the request is done.
+ */
+static _GLIBCXX_NORETURN void serve(int connection, CompileFunction& compile)
+{
+    std::uint32_t size;
+    int fds[2];
+    char control[CMSG_SPACE(sizeof(fds))];
+    iovec vector = { &size, sizeof(size) };
+    msghdr message = {};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    auto header = CMSG_FIRSTHDR(&message);
+    if (recvmsg(connection, &message, MSG_WAITALL) != sizeof(size) || header == nullptr || header->cmsg_type != SCM_RIGHTS)
+    {
+        _exit(1);
+    }
+
+    std::memcpy(fds, CMSG_DATA(header), sizeof(fds));
+    std::string payload(size, '\0');
+    if (!read_all(connection, payload.data(), size))
+    {
+        _exit(1);
+    }
+
+    // every string ends in '\0', so anything after the last one is not a whole string
+    std::vector<std::string> strings;
+    for (std::size_t start = 0, end; (end = payload.find('\0', start)) != std::string::npos; start = end + 1)
+    {
+        strings.push_back(payload.substr(start, end - start));
+    }
+
+    dup2(fds[0], STDOUT_FILENO);
+    dup2(fds[1], STDERR_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+
+    std::int32_t status = 1;
+    if (!strings.empty() && chdir(strings[0].c_str()) == 0)
+    {
+        status = compile(std::vector<std::string>(strings.begin() + 1, strings.end()));
+    }
+    else
+    {
+        std::cerr << "error: could not change to the client's directory\n";
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    write_all(connection, &status, sizeof(status));
+    std::exit(status);
+}
+
+/**
+ * Checks that the peer of the connection is run by the same user as the server, since it compiles with the server's
+ * permissions and writes to the files the peer names.
+ */
+static bool is_same_user(int connection)
+{
+    ucred credentials;
+    socklen_t size = sizeof(credentials);
+    return getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 && credentials.uid == getuid();
+}
+
+/**
+ * Removes the socket left behind by a server that is no longer running. Throws an error if a server is still
+ * listening on it, or if the path is not a socket, so that neither is taken over.
+ */
+static void remove_stale_socket(const std::string& socket_path, const sockaddr_un& address)
+{
+    struct stat status;
+    if (lstat(socket_path.c_str(), &status) != 0)
+    {
+        return;
+    }
+    else if (!S_ISSOCK(status.st_mode))
+    {
+        throw std::runtime_error(socket_path + " exists and is not a socket");
+    }
+
+    auto probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    auto is_live = probe >= 0 && connect(probe, (const sockaddr *)&address, sizeof(address)) == 0;
+    auto error = errno;
+    close(probe);
+    if (is_live)
+    {
+        throw std::runtime_error("a server is already listening on " + socket_path);
+    }
+    else if (error == ECONNREFUSED)
+    {
+        unlink(socket_path.c_str());
+    }
+}
+
+/**
+ * Serves compile requests on the socket until the server is killed. The target is set up once before any request
+ * is accepted, then each request is compiled in a process forked from the server, so it starts warm but cannot
+ * disturb the server or the other requests, which run concurrently up to max_jobs at a time. Only requests from the
+ * user running the server are served.
+ */
+void run_server(const std::string& socket_path, int max_jobs, CompileFunction compile)
+{
+    get_target_machine();
+
+    auto address = make_address(socket_path);
+    remove_stale_socket(socket_path, address);
+    auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (sockaddr *)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0)
+    {
+        throw std::runtime_error("could not listen on " + socket_path + ": " + std::strerror(errno));
+    }
+
+    std::cerr << "acc: listening on " << socket_path << "\n";
+
+    auto jobs = 0;
+    while (true)
+    {
+        while (jobs > 0 && waitpid(-1, nullptr, jobs >= max_jobs ? 0 : WNOHANG) > 0)
+        {
+            jobs--;
+        }
+
+        auto connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            continue;
+        }
+        else if (!is_same_user(connection))
+        {
+            close(connection);
+            continue;
+        }
+
+        auto pid = fork();
+        if (pid == 0)
+        {
+            close(listener);
+            serve(connection, compile);
+        }
+        else if (pid > 0)
+        {
+            jobs++;
+        }
+
+        close(connection);
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <sys/un.h>
+
+/**
+ * Compiles the arguments as if they had been passed to acc on the command line, and returns the exit status.
+ */
+using CompileFunction = std::function<int(const std::vector<std::string>& args)>;
+
+std::string get_server_socket_path();
+sockaddr_un make_address(const std::string& socket_path);
+bool read_all(int fd, void *buffer, std::size_t size);
+bool write_all(int fd, const void *buffer, std::size_t size);
+
+void run_server(const std::string& socket_path, int max_jobs, CompileFunction compile);
+int run_client(const std::string& socket_path, const std::vector<std::string>& args);
@@ -0,0 +1,128 @@
+#include <sstream>
+#include <vector>
+#include "Generator.hpp"
+
+static const std::vector<std::string> operators = { "+", "-", "*", "^", "&", "|" };
+
+/**
+ * Gets an identifier of the family, e.g. f for functions, padded to the identifier length.
+ */
+static std::string get_id(const std::string& family, int n, const GeneratorOptions& options)
+{
+    auto id = family + "_" + std::to_string(n);
+    auto padding = options.id_length - (int)id.size();
+    return padding > 0 ? family + std::string(padding, 'x') + "_" + std::to_string(n) : id;
+}
+
+static std::string indent(int level)
+{
+    return std::string(4 * level, ' ');
+}
+
+/**
+ * Generates the nested loops and if statements, alternating between the two, with an assignment in the innermost one.
+ * The loops run twice, so a deeply nested function still runs quickly.
+ */
+static void generate_nesting(std::stringstream& out, int level, const GeneratorOptions& options)
+{
+    if (level == options.depth)
+    {
+        out << indent(level + 1) << get_id("v", 2, options) << " = " << get_id("v", 2, options) << " + " << level << ";\n";
+        return;
+    }
+
+    auto counter = get_id("l", level, options);
+    if (level % 2 == 0)
+    {
+        out << indent(level + 1) << "for (" << counter << " = 0; " << counter << " < 2; " << counter << "++)\n";
+    }
+    else
+    {
+        out << indent(level + 1) << "if (" << get_id("v", 0, options) << " > " << level << ")\n";
+    }
+
+    out << indent(level + 1) << "{\n";
+    generate_nesting(out, level + 1, options);
+    out << indent(level + 1) << "}\n";
+}
+
+/**
+ * Generates an expression of the variables and constants with the number of terms, parenthesized every four terms.
+ */
+static std::string generate_expression(const GeneratorOptions& options)
+{
+    std::string expr = get_id("v", 0, options);
+    for (auto i = 1; i < options.terms; i++)
+    {
+        if (i % 4 == 0)
+        {
+            expr = "(" + expr + ")";
+        }
+
+        auto term = i % 2 == 0 ? get_id("v", i % 3, options) : std::to_string(i % 97 + 1);
+        expr += " " + operators[i % operators.size()] + " " + term;
+    }
+
+    return expr;
+}
+
+static void generate_function(std::stringstream& out, int n, const GeneratorOptions& options)
+{
+    auto a = get_id("a", n, options);
+    auto b = get_id("b", n, options);
+    out << "int " << get_id("f", n, options) << "(int " << a << ", int " << b << ")\n";
+    out << "{\n";
+    for (auto i = 0; i < 4; i++)
+    {
+        out << indent(1) << "int " << get_id("v", i, options) << ";\n";
+    }
+
+    for (auto i = 0; i < options.depth; i += 2)
+    {
+        out << indent(1) << "int " << get_id("l", i, options) << ";\n";
+    }
+
+    out << indent(1) << get_id("v", 0, options) << " = " << a << ";\n";
+    out << indent(1) << get_id("v", 1, options) << " = " << b << ";\n";
+    out << indent(1) << get_id("v", 2, options) << " = 0;\n";
+    generate_nesting(out, 0, options);
+
+    auto v3 = get_id("v", 3, options);
+    out << indent(1) << v3 << " = (" << generate_expression(options) << ") & 65535;\n";
+    for (auto i = 0; i < options.branches; i++)
+    {
+        out << indent(1) << (i == 0 ? "if" : "else if") << " (" << v3 << " % " << options.branches << " == " << i << ")\n";
+        out << indent(1) << "{\n";
+        out << indent(2) << get_id("v", 2, options) << " = " << get_id("v", 2, options) << " + " << get_id("v", i % 2, options) << " * " << i << ";\n";
+        out << indent(1) << "}\n";
+    }
+
+    out << indent(1) << "return " << get_id("v", 2, options) << " + " << v3;
+    if (n > 0)
+    {
+        out << " + " << get_id("f", n - 1, options) << "(" << get_id("v", 0, options) << ", " << get_id("v", 1, options) << ") % 1024";
+    }
+
+    out << ";\n";
+    out << "}\n\n";
+}
+
+/**
+ * Generates a program of the shape. The program is valid input for acc, prints one number and exits with 0.
+ */
+std::string generate_program(const GeneratorOptions& options)
+{
+    std::stringstream out;
+    out << "extern void println(int n);\n\n";
+    for (auto i = 0; i < options.functions; i++)
+    {
+        generate_function(out, i, options);
+    }
+
+    out << "int main()\n";
+    out << "{\n";
+    out << indent(1) << "println(" << get_id("f", options.functions - 1, options) << "(1, 2));\n";
+    out << indent(1) << "return 0;\n";
+    out << "}\n";
+    return out.str();
+}
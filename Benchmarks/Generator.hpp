@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+/**
+ * The shape of a synthetic program made by generate_program.
+ */
+struct GeneratorOptions
+{
+    // the number of functions, each of which calls the one before it
+    int functions = 16;
+
+    // how deeply the loops and if statements in each function are nested
+    int depth = 4;
+
+    // the number of terms in the long expression of each function
+    int terms = 16;
+
+    // the number of branches in the if-else chain of each function
+    int branches = 8;
+
+    // the least number of characters in each identifier
+    int id_length = 8;
+};
+
+std::string generate_program(const GeneratorOptions& options);
@@ -0,0 +1,174 @@
+#include <memory>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "CFG.hpp"
+#include "Codegen.hpp"
+#include "Options.hpp"
+#include "Generator.hpp"
+
+/**
+ * The part of the shape of the generated program that a benchmark grows, to the size given by its argument.
+ */
+enum class Knob
+{
+    Functions,
+    Depth,
+    Terms,
+    Branches,
+    IdLength,
+};
+
+static std::string generate_input(benchmark::State& state, Knob knob)
+{
+    GeneratorOptions options;
+    auto size = state.range(0);
+    switch (knob)
+    {
+        case Knob::Functions:
+            options.functions = size;
+            break;
+        case Knob::Depth:
+            options.depth = size;
+            break;
+        case Knob::Terms:
+            options.terms = size;
+            break;
+        case Knob::Branches:
+            options.branches = size;
+            break;
+        case Knob::IdLength:
+            options.id_length = size;
+            break;
+    }
+
+    return generate_program(options);
+}
+
+static std::shared_ptr<Program> parse(const std::string& input)
+{
+    Lexer lexer(input);
+    Parser parser(lexer);
+    return parser.parse();
+}
+
+/**
+ * Reports the size of the input, so the complexity of the stage can be fitted, and its throughput in bytes.
+ */
+static void set_counters(benchmark::State& state, const std::string& input)
+{
+    state.SetComplexityN(state.range(0));
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static void BM_Lexer(benchmark::State& state, Knob knob)
+{
+    auto input = generate_input(state, knob);
+    for (auto _ : state)
+    {
+        Lexer lexer(input);
+        benchmark::DoNotOptimize(lexer.size());
+    }
+
+    set_counters(state, input);
+}
+
+static void BM_Parse(benchmark::State& state, Knob knob)
+{
+    auto input = generate_input(state, knob);
+    Lexer lexer(input);
+    std::shared_ptr<Program> program;
+    for (auto _ : state)
+    {
+        // the previous program is freed outside of the timing
+        state.PauseTiming();
+        program = nullptr;
+        state.ResumeTiming();
+
+        Parser parser(lexer);
+        program = parser.parse();
+    }
+
+    set_counters(state, input);
+}
+
+static void BM_IRCodegen(benchmark::State& state, Knob knob)
+{
+    auto input = generate_input(state, knob);
+    std::shared_ptr<Program> program;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        program = parse(input);
+        state.ResumeTiming();
+
+        program->ir_codegen();
+    }
+
+    set_counters(state, input);
+}
+
+static void BM_ConstructCFG(benchmark::State& state, Knob knob)
+{
+    auto input = generate_input(state, knob);
+    auto program = parse(input);
+    program->ir_codegen();
+    for (auto _ : state)
+    {
+        for (auto& f : program->functions)
+        {
+            if (!f->is_proto())
+            {
+                benchmark::DoNotOptimize(ConstructCFG(f->ir_list));
+            }
+        }
+    }
+
+    set_counters(state, input);
+}
+
+static void BM_Codegen(benchmark::State& state, Knob knob)
+{
+    auto input = generate_input(state, knob);
+    Options options;
+    llvm::LLVMContext llvm_context;
+    std::unique_ptr<llvm::Module> module;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        module = nullptr;
+        auto program = parse(input);
+        program->ir_codegen();
+        program->ir_optimize(options);
+        state.ResumeTiming();
+
+        module = codegen(program, llvm_context, options);
+
+        // the program is freed outside of the timing
+        state.PauseTiming();
+        program = nullptr;
+        state.ResumeTiming();
+    }
+
+    set_counters(state, input);
+}
+
+// every stage over the number of functions
+BENCHMARK_CAPTURE(BM_Lexer, functions, Knob::Functions)->RangeMultiplier(4)->Range(4, 256)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Parse, functions, Knob::Functions)->RangeMultiplier(4)->Range(4, 256)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_IRCodegen, functions, Knob::Functions)->RangeMultiplier(4)->Range(4, 256)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ConstructCFG, functions, Knob::Functions)->RangeMultiplier(4)->Range(4, 256)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Codegen, functions, Knob::Functions)->RangeMultiplier(4)->Range(4, 256)->Complexity()->Unit(benchmark::kMillisecond);
+
+// the stages that each shape stresses most
+BENCHMARK_CAPTURE(BM_Lexer, id_length, Knob::IdLength)->RangeMultiplier(4)->Range(8, 8192)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Parse, depth, Knob::Depth)->RangeMultiplier(2)->Range(2, 128)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Parse, terms, Knob::Terms)->RangeMultiplier(4)->Range(16, 1024)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_IRCodegen, terms, Knob::Terms)->RangeMultiplier(4)->Range(16, 1024)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ConstructCFG, branches, Knob::Branches)->RangeMultiplier(4)->Range(8, 512)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Codegen, branches, Knob::Branches)->RangeMultiplier(4)->Range(8, 512)->Complexity()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,24 @@
+#include <iostream>
+#include <tclap/CmdLine.h>
+#include "Generator.hpp"
+
+int main(int argc, char *argv[])
+{
+    GeneratorOptions options;
+    TCLAP::CmdLine cmd("Generate a synthetic program for Alexander's C Compiler", ' ', "1.0");
+    TCLAP::ValueArg<int> functions_arg("f", "functions", "The number of functions", false, options.functions, "int", cmd);
+    TCLAP::ValueArg<int> depth_arg("d", "depth", "How deeply the loops and if statements are nested", false, options.depth, "int", cmd);
+    TCLAP::ValueArg<int> terms_arg("t", "terms", "The number of terms in the long expression of each function", false, options.terms, "int", cmd);
+    TCLAP::ValueArg<int> branches_arg("b", "branches", "The number of branches in the if-else chain of each function", false, options.branches, "int", cmd);
+    TCLAP::ValueArg<int> id_length_arg("i", "id-length", "The least number of characters in each identifier", false, options.id_length, "int", cmd);
+
+    cmd.parse(argc, argv);
+
+    options.functions = functions_arg.getValue();
+    options.depth = depth_arg.getValue();
+    options.terms = terms_arg.getValue();
+    options.branches = branches_arg.getValue();
+    options.id_length = id_length_arg.getValue();
+    std::cout << generate_program(options);
+    return 0;
+}
@@ -0,0 +1,47 @@
+extern void println(int n);
+
+long steps;
+int longest;
+int longest_start;
+
+// follows the Collatz sequence from n down to 1, counting the steps in the globals
+void collatz(long n, int start)
+{
+    int length = 0;
+    while (n != 1)
+    {
+        if (n % 2 == 0)
+        {
+            n = n / 2;
+        }
+        else
+        {
+            n = 3 * n + 1;
+        }
+
+        length++;
+    }
+
+    steps += length;
+    if (length > longest)
+    {
+        longest = length;
+        longest_start = start;
+    }
+}
+
+int main()
+{
+    int i;
+    steps = 0;
+    longest = 0;
+    for (i = 1; i < 500000; i++)
+    {
+        collatz(i, i);
+    }
+
+    println((int)(steps / 1000));
+    println(longest);
+    println(longest_start);
+    return 0;
+}
@@ -0,0 +1,33 @@
+extern void println(int n);
+
+int fib(int n)
+{
+    if (n < 2)
+    {
+        return n;
+    }
+
+    return fib(n - 1) + fib(n - 2);
+}
+
+// the number of ways to climb n stairs taking 1, 2 or 3 steps at a time
+int tribonacci(int n)
+{
+    if (n < 0)
+    {
+        return 0;
+    }
+    else if (n == 0)
+    {
+        return 1;
+    }
+
+    return tribonacci(n - 1) + tribonacci(n - 2) + tribonacci(n - 3);
+}
+
+int main()
+{
+    println(fib(35));
+    println(tribonacci(27));
+    return 0;
+}
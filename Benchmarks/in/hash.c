@@ -0,0 +1,61 @@
+extern void println(int n);
+
+unsigned int seed;
+
+// a xorshift random number generator
+unsigned int next_random()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// hashes the words with FNV-1a
+unsigned int fnv(unsigned int words[], int n)
+{
+    unsigned int h = 2166136261;
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        h = (h ^ words[i]) * 16777619;
+    }
+
+    return h;
+}
+
+int main()
+{
+    unsigned int words[4096];
+    unsigned int counts[256];
+    int i, round;
+    seed = 2463534242;
+    for (i = 0; i < 256; i++)
+    {
+        counts[i] = 0;
+    }
+
+    for (round = 0; round < 4000; round++)
+    {
+        for (i = 0; i < 4096; i++)
+        {
+            words[i] = next_random();
+        }
+
+        int bucket = fnv(words, 4096) & 255;
+        counts[bucket] = counts[bucket] + 1;
+    }
+
+    int max = 0;
+    for (i = 0; i < 256; i++)
+    {
+        if (counts[i] > max)
+        {
+            max = counts[i];
+        }
+    }
+
+    println(max);
+    println(seed & 65535);
+    return 0;
+}
@@ -0,0 +1,45 @@
+extern void println(int n);
+
+// the number of iterations before the point escapes the circle of radius 2, at most limit
+int escape_time(double x0, double y0, int limit)
+{
+    double x = 0.0;
+    double y = 0.0;
+    int i = 0;
+    while (i < limit && x * x + y * y <= 4.0)
+    {
+        double t = x * x - y * y + x0;
+        y = 2.0 * x * y + y0;
+        x = t;
+        i++;
+    }
+
+    return i;
+}
+
+int main()
+{
+    int width = 900;
+    int height = 600;
+    int row, col, inside, total;
+    inside = 0;
+    total = 0;
+    for (row = 0; row < height; row++)
+    {
+        for (col = 0; col < width; col++)
+        {
+            double x = -2.0 + col * 3.0 / width;
+            double y = -1.0 + row * 2.0 / height;
+            int n = escape_time(x, y, 200);
+            total += n;
+            if (n == 200)
+            {
+                inside++;
+            }
+        }
+    }
+
+    println(inside);
+    println(total);
+    return 0;
+}
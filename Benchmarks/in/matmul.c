@@ -0,0 +1,53 @@
+extern void println(int n);
+
+// multiplies the n by n matrices a and b into c, stored by rows
+void multiply(double a[], double b[], double c[], int n)
+{
+    int i, j, k;
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < n; j++)
+        {
+            double sum = 0.0;
+            for (k = 0; k < n; k++)
+            {
+                sum = sum + a[i * n + k] * b[k * n + j];
+            }
+
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+int main()
+{
+    double a[40000];
+    double b[40000];
+    double c[40000];
+    int n = 200;
+    int i, round;
+    for (i = 0; i < n * n; i++)
+    {
+        a[i] = (i % 17) * 0.25;
+        b[i] = (i % 13) * 0.5 - 2.0;
+    }
+
+    for (round = 0; round < 8; round++)
+    {
+        multiply(a, b, c, n);
+        for (i = 0; i < n * n; i++)
+        {
+            a[i] = c[i] / 1000.0;
+        }
+    }
+
+    double trace = 0.0;
+    for (i = 0; i < n; i++)
+    {
+        trace = trace + c[i * n + i];
+    }
+
+    println((int)(trace * 1000.0));
+    println((int)(c[n * n - 1] * 1000000.0));
+    return 0;
+}
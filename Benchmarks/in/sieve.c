@@ -0,0 +1,41 @@
+extern void println(int n);
+
+// counts the primes below n with the sieve of Eratosthenes
+int count_primes(int n)
+{
+    int composite[200000];
+    int i, j, count;
+    for (i = 0; i < n; i++)
+    {
+        composite[i] = 0;
+    }
+
+    count = 0;
+    for (i = 2; i < n; i++)
+    {
+        if (composite[i] == 0)
+        {
+            count++;
+            for (j = i + i; j < n; j += i)
+            {
+                composite[j] = 1;
+            }
+        }
+    }
+
+    return count;
+}
+
+int main()
+{
+    int round, total;
+    total = 0;
+    for (round = 0; round < 100; round++)
+    {
+        total += count_primes(200000 - round);
+    }
+
+    println(count_primes(200000));
+    println(total);
+    return 0;
+}
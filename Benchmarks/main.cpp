@@ -0,0 +1,337 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <stdlib.h>
+#include <tclap/CmdLine.h>
+
+static std::string indir = "Benchmarks/in";
+static std::string outdir = "Benchmarks/out";
+static std::string test_code_path = "Tests/test-link/test-code.c";
+
+struct Args
+{
+    int runs;
+    std::string bench;
+    std::string baseline;
+    std::string save;
+    double threshold;
+
+    Args(int argc, char *argv[])
+    {
+        TCLAP::CmdLine cmd("Benchmark Alexander's C Compiler", ' ', "1.0");
+        TCLAP::ValueArg<int> runs_arg("r", "runs", "The number of times to compile and run each benchmark", false, 5, "int", cmd);
+        TCLAP::ValueArg<std::string> bench_arg("b", "bench", "Specify a benchmark to run", false, "", "string", cmd);
+        TCLAP::ValueArg<std::string> baseline_arg("", "baseline", "Compare the results to the results saved in the file", false, "", "string", cmd);
+        TCLAP::ValueArg<std::string> save_arg("", "save", "Save the results to the file, to use as a baseline later", false, "", "string", cmd);
+        TCLAP::ValueArg<double> threshold_arg("", "threshold", "The percent a result of acc can grow over the baseline before it is a regression", false, 10, "double", cmd);
+
+        cmd.parse(argc, argv);
+
+        runs = runs_arg.getValue();
+        bench = bench_arg.getValue();
+        baseline = baseline_arg.getValue();
+        save = save_arg.getValue();
+        threshold = threshold_arg.getValue();
+    }
+};
+
+/**
+ * A way of compiling a benchmark into an executable. The commands are run in order, with {src}, {exe} and {runtime}
+ * replaced by the benchmark, the executable and the object file of the test runtime, which defines println.
+ * acc has no -O levels, its own passes always run. Its output is lowered by clang at -O0 and -O2, so the second also
+ * runs the LLVM optimizer on it, and -flto runs the LLVM optimizer in acc.
+ */
+struct Config
+{
+    std::string name;
+    bool is_acc;
+    std::vector<std::string> commands;
+};
+
+static std::vector<Config> configs = {
+    { "clang -O0", false, { "clang-18 -O0 {src} {runtime} -o {exe}" } },
+    { "clang -O2", false, { "clang-18 -O2 {src} {runtime} -o {exe}" } },
+    { "acc -O0", true, { "./acc -emit-bc {src} -o {exe}.bc", "clang-18 -O0 {exe}.bc {runtime} -o {exe}" } },
+    { "acc -O2", true, { "./acc -emit-bc {src} -o {exe}.bc", "clang-18 -O2 {exe}.bc {runtime} -o {exe}" } },
+    { "acc -flto", true, { "./acc -flto {src} -o {exe}.o", "clang-18 {exe}.o {runtime} -o {exe}" } },
+};
+
+/**
+ * The medians of one benchmark compiled with one config.
+ */
+struct Result
+{
+    std::string bench;
+    std::string config;
+    double compile_ms;
+    double run_ms;
+    std::uintmax_t size;
+
+    // whether the config compiles with acc, which is only known for the results of this run
+    bool is_acc = false;
+};
+
+static std::string replace_all(std::string str, const std::string& from, const std::string& to)
+{
+    for (auto pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos + to.size()))
+    {
+        str.replace(pos, from.size(), to);
+    }
+
+    return str;
+}
+
+static double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    auto n = values.size();
+    return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+/**
+ * Runs the command and returns how long it took in milliseconds, or -1 if it failed.
+ */
+static double time_command(const std::string& cmd)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto ec = system(cmd.c_str());
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return ec == 0 ? elapsed.count() : -1;
+}
+
+static std::string read_file(const std::string& filepath)
+{
+    std::ifstream file(filepath);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+/**
+ * Compiles and runs the benchmark with the config the given number of times. Returns false if it did not compile or
+ * run, or if its output is not the expected output. If there is no expected output yet, its output becomes it.
+ */
+static bool run_bench(const std::string& bench, const Config& config, std::string& expected, int runs, Result& result)
+{
+    auto exe = outdir + "/" + bench + "-" + replace_all(config.name, " ", "");
+    std::vector<double> compile_times;
+    for (auto i = 0; i < runs; i++)
+    {
+        double total = 0;
+        for (auto& command : config.commands)
+        {
+            auto cmd = replace_all(command, "{src}", indir + "/" + bench + ".c");
+            cmd = replace_all(cmd, "{exe}", exe);
+            cmd = replace_all(cmd, "{runtime}", outdir + "/test-code.o");
+            auto time = time_command(cmd);
+            if (time < 0)
+            {
+                std::cerr << "command: " << cmd << " failed for benchmark " << bench << "\n";
+                return false;
+            }
+
+            total += time;
+        }
+
+        compile_times.push_back(total);
+    }
+
+    std::vector<double> run_times;
+    for (auto i = 0; i < runs; i++)
+    {
+        auto time = time_command("./" + exe + " > " + exe + ".out");
+        if (time < 0)
+        {
+            std::cerr << "benchmark " << bench << " failed to run with " << config.name << "\n";
+            return false;
+        }
+
+        run_times.push_back(time);
+    }
+
+    auto output = read_file(exe + ".out");
+    if (expected.empty())
+    {
+        expected = output;
+    }
+    else if (output != expected)
+    {
+        std::cerr << "output of benchmark " << bench << " with " << config.name << " did not match clang\n";
+        return false;
+    }
+
+    result = { bench, config.name, median(compile_times), median(run_times), std::filesystem::file_size(exe), config.is_acc };
+    return true;
+}
+
+/**
+ * Finds the benchmarks in the input directory, or only the one that was asked for.
+ */
+static std::vector<std::string> find_benches(const Args& args)
+{
+    std::vector<std::string> benches;
+    for (auto& entry : std::filesystem::directory_iterator(indir))
+    {
+        auto bench = entry.path().stem().string();
+        if (entry.path().extension() == ".c" && (args.bench.empty() || args.bench == bench))
+        {
+            benches.push_back(bench);
+        }
+    }
+
+    std::sort(benches.begin(), benches.end());
+    return benches;
+}
+
+static void print_results(const std::vector<Result>& results)
+{
+    std::cout << std::left << std::setw(14) << "benchmark" << std::setw(12) << "config" << std::right
+        << std::setw(14) << "compile (ms)" << std::setw(12) << "run (ms)" << std::setw(14) << "vs clang -O2"
+        << std::setw(14) << "size (bytes)" << "\n";
+
+    std::map<std::string, double> clang_times;
+    for (auto& result : results)
+    {
+        if (result.config == "clang -O2")
+        {
+            clang_times[result.bench] = result.run_ms;
+        }
+    }
+
+    for (auto& result : results)
+    {
+        std::stringstream ratio;
+        if (clang_times.find(result.bench) != clang_times.end())
+        {
+            ratio << std::fixed << std::setprecision(2) << result.run_ms / clang_times[result.bench] << "x";
+        }
+
+        std::cout << std::left << std::setw(14) << result.bench << std::setw(12) << result.config << std::right
+            << std::fixed << std::setprecision(1) << std::setw(14) << result.compile_ms << std::setw(12) << result.run_ms
+            << std::setw(14) << ratio.str() << std::setw(14) << result.size << "\n";
+    }
+}
+
+/**
+ * Saves the results as tab separated lines of the benchmark, config, compile time, run time and size.
+ */
+static void save_results(const std::string& filepath, const std::vector<Result>& results)
+{
+    std::ofstream file(filepath);
+    for (auto& result : results)
+    {
+        file << result.bench << "\t" << result.config << "\t" << result.compile_ms << "\t" << result.run_ms << "\t" << result.size << "\n";
+    }
+}
+
+static std::map<std::pair<std::string, std::string>, Result> load_results(const std::string& filepath)
+{
+    std::map<std::pair<std::string, std::string>, Result> results;
+    std::ifstream file(filepath);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::stringstream fields(line);
+        Result result;
+        std::string compile_ms, run_ms, size;
+        std::getline(fields, result.bench, '\t');
+        std::getline(fields, result.config, '\t');
+        std::getline(fields, compile_ms, '\t');
+        std::getline(fields, run_ms, '\t');
+        std::getline(fields, size, '\t');
+        result.compile_ms = std::stod(compile_ms);
+        result.run_ms = std::stod(run_ms);
+        result.size = std::stoull(size);
+        results[{ result.bench, result.config }] = result;
+    }
+
+    return results;
+}
+
+/**
+ * Compares the results of acc to the baseline, and reports each one that grew by more than the threshold percent.
+ * The results of clang are not compared, they only show how much the machine varies. Returns the number of regressions.
+ */
+static int compare_results(const std::vector<Result>& results, const std::string& baseline_path, double threshold)
+{
+    auto baseline = load_results(baseline_path);
+    auto limit = 1 + threshold / 100;
+    auto regressions = 0;
+    for (auto& result : results)
+    {
+        auto it = baseline.find({ result.bench, result.config });
+        if (it == baseline.end() || !result.is_acc)
+        {
+            continue;
+        }
+
+        auto& base = it->second;
+        std::vector<std::tuple<std::string, double, double>> metrics = {
+            { "compile time", base.compile_ms, result.compile_ms },
+            { "run time", base.run_ms, result.run_ms },
+            { "size", (double)base.size, (double)result.size },
+        };
+
+        for (auto& [name, before, after] : metrics)
+        {
+            if (after > before * limit)
+            {
+                std::cerr << "regression: " << result.bench << " with " << result.config << ": " << name << " grew from "
+                    << before << " to " << after << "\n";
+                regressions++;
+            }
+        }
+    }
+
+    return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+    Args args(argc, argv);
+
+    std::filesystem::remove_all(outdir);
+    std::filesystem::create_directory(outdir);
+    if (system(("clang-18 -O2 -c " + test_code_path + " -o " + outdir + "/test-code.o").c_str()) != 0)
+    {
+        std::cerr << "failed to compile " << test_code_path << "\n";
+        return 1;
+    }
+
+    auto failures = 0;
+    std::vector<Result> results;
+    for (auto& bench : find_benches(args))
+    {
+        // the output of the first config, clang -O0, is the expected output of the others
+        std::string expected;
+        for (auto& config : configs)
+        {
+            Result result;
+            if (run_bench(bench, config, expected, args.runs, result))
+            {
+                results.push_back(result);
+            }
+            else
+            {
+                failures++;
+            }
+        }
+    }
+
+    print_results(results);
+    if (!args.save.empty())
+    {
+        save_results(args.save, results);
+    }
+
+    auto regressions = args.baseline.empty() ? 0 : compare_results(results, args.baseline, args.threshold);
+    return failures > 0 || regressions > 0 ? 1 : 0;
+}
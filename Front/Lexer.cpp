@@ -34,9 +34,17 @@ void Lexer::lex()
         {
             lex_comment();
         }
+        else if (isinclude())
+        {
+            lex_include();
+        }
+        else if (ispragma())
+        {
+            lex_pragma();
+        }
         else if (isdigit())
         {
-            auto token = lex_integer();
+            auto token = lex_number();
             add(token);
         }
         else if (isid() && !isdigit())
@@ -105,7 +113,9 @@ std::optional<Token> Lexer::attempt_lex_keyword()
         auto n = keyword.length();
         if (index + n < input.length())
         {
-            if (slice(n) == keyword)
+            // the keyword must not be the prefix of an identifier
+            auto next = input[index + n];
+            if (slice(n) == keyword && !std::isalnum(next) && next != '_')
             {
                 advance(n);
                 return Token(keyword, keyword, span(keyword));
@@ -117,12 +127,48 @@ std::optional<Token> Lexer::attempt_lex_keyword()
 }
 
 /**
- * Lexes an integer.
+ * Lexes an integer or floating point number, including any suffixes.
  */
-Token Lexer::lex_integer()
+Token Lexer::lex_number()
 {
     std::string value = "";
-    while (!eof() && isdigit())
+    while (!eof() && isfloat())
+    {
+        value += current();
+        advance();
+    }
+
+    // an exponent makes the number a float, even without a decimal point
+    bool has_exponent = !eof() && (current() == 'e' || current() == 'E');
+    if (has_exponent)
+    {
+        value += current();
+        advance();
+        if (!eof() && (current() == '+' || current() == '-'))
+        {
+            value += current();
+            advance();
+        }
+
+        while (!eof() && isdigit())
+        {
+            value += current();
+            advance();
+        }
+    }
+
+    if (has_exponent || value.find('.') != std::string::npos)
+    {
+        if (!eof() && float_suffix_chars.find(current()) != std::string::npos)
+        {
+            value += current();
+            advance();
+        }
+
+        return Token(TokenType_Float, value, span(value));
+    }
+
+    while (!eof() && integer_suffix_chars.find(current()) != std::string::npos)
     {
         value += current();
         advance();
@@ -238,6 +284,63 @@ void Lexer::lex_comment()
     }
 }
 
+/**
+ * Lexes an include directive. Only the standard headers are included, and the declarations in them
+ * that the compiler supports (e.g. the fixed width integer types) are built in, so the line is skipped.
+ */
+void Lexer::lex_include()
+{
+    while (!eof() && !isnewline())
+    {
+        advance();
+    }
+}
+
+/**
+ * Lexes a pragma directive. #pragma unroll, #pragma unroll(N), #pragma unroll N and #pragma nounroll
+ * become an unroll token for the loop that follows, where nounroll is a count of 1. Other pragmas are skipped.
+ */
+void Lexer::lex_pragma()
+{
+    auto start = pos();
+    std::string line = "";
+    while (!eof() && !isnewline())
+    {
+        line += current();
+        advance();
+    }
+
+    std::string directive = "";
+    std::string count = "";
+    for (auto c : line.substr(pragma_directive.length()))
+    {
+        if (std::isalpha(c) || c == '_')
+        {
+            directive += c;
+        }
+        else if (std::isdigit(c))
+        {
+            count += c;
+        }
+        else if (!std::isspace(c) && c != '(' && c != ')')
+        {
+            break;
+        }
+    }
+
+    if (directive == "nounroll")
+    {
+        count = "1";
+    }
+    else if (directive != "unroll")
+    {
+        return;
+    }
+
+    Token token(TokenType_Unroll, count, Span(start, pos()));
+    add(token);
+}
+
 /**
  * Determines if any string in the vector of strings contains a char.
  */
@@ -8,6 +8,8 @@
 
 inline std::string TokenType_Id = "ID";
 inline std::string TokenType_Int = "INT";
+inline std::string TokenType_Float = "FLOAT";
+inline std::string TokenType_Unroll = "UNROLL"; // #pragma unroll, the value is the count or empty
 
 /**
  * A token produced by lexical analysis.
@@ -29,7 +31,8 @@ const std::vector<std::string> seperators = {
     "{",
     "}",
     "[",
-    "]"
+    "]",
+    ":"
 };
 
 // The list of operator tokens.
@@ -40,6 +43,11 @@ const std::vector<std::string> operators = {
     "/",
     "%",
     "&",
+    "|",
+    "^",
+    "~",
+    "<<",
+    ">>",
     "=",
     "!",
     "==",
@@ -56,21 +64,78 @@ const std::vector<std::string> operators = {
     "-=",
     "*=",
     "/=",
-    "%="
+    "%=",
+    "&=",
+    "|=",
+    "^=",
+    "<<=",
+    ">>="
 };
 
 // The list of keywords.
 const std::vector<std::string> keywords = {
     "void",
     "int",
+    "char",
+    "short",
+    "long",
+    "float",
+    "double",
+    "signed",
+    "unsigned",
+    "int8_t",
+    "int16_t",
+    "int32_t",
+    "int64_t",
+    "uint8_t",
+    "uint16_t",
+    "uint32_t",
+    "uint64_t",
+    "size_t",
     "if",
     "else",
     "while",
     "for",
     "return",
-    "extern"
+    "extern",
+    "restrict",
+    "switch",
+    "case",
+    "default",
+    "break"
 };
 
+// The list of keywords that can start a type.
+const std::vector<std::string> type_keywords = {
+    "void",
+    "int",
+    "char",
+    "short",
+    "long",
+    "float",
+    "double",
+    "signed",
+    "unsigned",
+    "int8_t",
+    "int16_t",
+    "int32_t",
+    "int64_t",
+    "uint8_t",
+    "uint16_t",
+    "uint32_t",
+    "uint64_t",
+    "size_t"
+};
+
+// The suffixes of an integer literal.
+const std::string integer_suffix_chars = "uUlL";
+
+// The suffixes of a floating point literal.
+const std::string float_suffix_chars = "fFlL";
+
+const std::string include_directive = "#include";
+const std::string pragma_directive = "#pragma";
+
 const std::string single_line_comment = "//";
 const std::string multi_line_comment_start = "/*";
 const std::string multi_line_comment_end = "*/";
@@ -91,11 +156,13 @@ private:
     void lex();
 
     std::optional<Token> attempt_lex_keyword();
-    Token lex_integer();
+    Token lex_number();
     Token lex_id();
     Token lex_sep();
     Token lex_op();
     void lex_comment();
+    void lex_include();
+    void lex_pragma();
 
     void advance();
     void advance(const int n);
@@ -110,6 +177,8 @@ private:
     inline bool isnewline() const { return current() == '\n'; }
     inline bool iswhitespace() const { return std::isspace(current()); }
     inline bool iscomment() const { return index < input.size() - 1 && (slice(2) == single_line_comment || slice(2) == multi_line_comment_start); }
+    inline bool isinclude() const { return slice(include_directive.length()) == include_directive; }
+    inline bool ispragma() const { return slice(pragma_directive.length()) == pragma_directive; }
     inline bool isdigit() const { return std::isdigit(current()); }
     inline bool isfloat() const { return isdigit() || current() == '.'; }
     inline bool isalpha() const { return std::isalpha(current()); } 
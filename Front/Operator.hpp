@@ -20,11 +20,16 @@ enum class Associativity
 const std::vector<std::tuple<std::vector<std::string>, Associativity>> operator_precedence = {
     std::tuple<std::vector<std::string>, Associativity>({ "*", "/", "%" }, Associativity::Left),                        /*  3  */   
     std::tuple<std::vector<std::string>, Associativity>({ "+", "-" }, Associativity::Left),                             /*  4  */   
+    std::tuple<std::vector<std::string>, Associativity>({ "<<", ">>" }, Associativity::Left),                           /*  5  */   
     std::tuple<std::vector<std::string>, Associativity>({ "<", "<=", ">", ">=" }, Associativity::Left),                 /*  6  */   
     std::tuple<std::vector<std::string>, Associativity>({ "==", "!=" }, Associativity::Left),                           /*  7  */   
+    std::tuple<std::vector<std::string>, Associativity>({ "&" }, Associativity::Left),                                  /*  8  */   
+    std::tuple<std::vector<std::string>, Associativity>({ "^" }, Associativity::Left),                                  /*  9  */   
+    std::tuple<std::vector<std::string>, Associativity>({ "|" }, Associativity::Left),                                  /* 10  */   
     std::tuple<std::vector<std::string>, Associativity>({ "&&" }, Associativity::Left),                                 /* 11  */   
     std::tuple<std::vector<std::string>, Associativity>({ "||" }, Associativity::Left),                                 /* 12  */   
-    std::tuple<std::vector<std::string>, Associativity>({ "=", "+=", "-=", "*=", "/=", "%=" }, Associativity::Right)    /* 14  */   
+    std::tuple<std::vector<std::string>, Associativity>({ "=", "+=", "-=", "*=", "/=", "%=", 
+                                                          "&=", "|=", "^=", "<<=", ">>=" }, Associativity::Right)    /* 14  */   
 };
 
 /**
@@ -43,6 +48,11 @@ enum class BinOp
     LessThanEqual,
     GreaterThan,
     GreaterThanEqual,
+    BitAnd,
+    BitOr,
+    BitXor,
+    ShiftLeft,
+    ShiftRight,
     And,
     Or,
     Assign,
@@ -50,17 +60,27 @@ enum class BinOp
     MinusAssign,
     TimesAssign,
     DivideAssign,
-    ModuloAssign
+    ModuloAssign,
+    BitAndAssign,
+    BitOrAssign,
+    BitXorAssign,
+    ShiftLeftAssign,
+    ShiftRightAssign
 };
 
 const std::map<const std::string, const BinOp> binop_map = {
     {"*", BinOp::Times}, {"/", BinOp::Divide}, {"%", BinOp::Modulo},
     {"+", BinOp::Plus}, {"-", BinOp::Minus},
+    {"<<", BinOp::ShiftLeft}, {">>", BinOp::ShiftRight},
     {"<", BinOp::LessThan}, {"<=", BinOp::LessThanEqual}, {">", BinOp::GreaterThan}, {">=", BinOp::GreaterThanEqual},
     {"==", BinOp::Equal}, {"!=", BinOp::NotEqual},
+    {"&", BinOp::BitAnd},
+    {"^", BinOp::BitXor},
+    {"|", BinOp::BitOr},
     {"&&", BinOp::And},
     {"||", BinOp::Or}, 
     {"=", BinOp::Assign}, {"+=", BinOp::PlusAssign}, {"-=", BinOp::MinusAssign}, {"*=", BinOp::TimesAssign}, {"/=", BinOp::DivideAssign}, {"%=", BinOp::ModuloAssign},
+    {"&=", BinOp::BitAndAssign}, {"|=", BinOp::BitOrAssign}, {"^=", BinOp::BitXorAssign}, {"<<=", BinOp::ShiftLeftAssign}, {">>=", BinOp::ShiftRightAssign},
 };
 
 /**
@@ -70,6 +90,7 @@ enum class UnOp
 {
     Negation,
     Not,
+    BitNot,
     Deref,
     AddrOf,
     PlusPlus,
@@ -78,7 +99,7 @@ enum class UnOp
 
 const std::map<const std::string, const UnOp> unop_map = {
     {"++", UnOp::PlusPlus}, {"--", UnOp::MinusMinus},
-    {"-", UnOp::Negation}, {"!", UnOp::Not}, {"*", UnOp::Deref}, {"&", UnOp::AddrOf},
+    {"-", UnOp::Negation}, {"!", UnOp::Not}, {"~", UnOp::BitNot}, {"*", UnOp::Deref}, {"&", UnOp::AddrOf},
 };
 
 
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <iostream>
+
+/**
+ * The options that control how a program is compiled, set from the command line.
+ */
+struct Options
+{
+    /* allow floating point math to be reassociated, contracted and vectorized, as if it were exact */
+    bool fast_math = false;
+
+    /* vectorize counted loops over arrays */
+    bool vectorize = true;
+
+    /* unroll every counted loop, not just the ones marked with #pragma unroll */
+    bool unroll_loops = false;
+
+    /* the number of copies of the body to make when unrolling a loop whose trip count is not known */
+    int unroll_count = 4;
+
+    /* the program is made of just the compiled files, so nothing outside of them can access their globals */
+    bool whole_program = false;
+
+    /* trap on accesses outside of arrays of known size */
+    bool bounds_check = false;
+
+    /* the passes that report what they did and did not do, e.g. vectorize for -Rpass=vectorize */
+    std::set<std::string> remarks;
+
+    inline bool remark_enabled(const std::string& pass) const { return remarks.find(pass) != remarks.end(); }
+
+    /**
+     * Reports what a pass did to a function, if remarks are enabled for the pass.
+     */
+    inline void remark(const std::string& pass, const std::string& function_name, const std::string& message) const
+    {
+        if (remark_enabled(pass))
+        {
+            std::cerr << "remark: " << function_name << ": " << message << " [-Rpass=" << pass << "]\n";
+        }
+    }
+
+    /**
+     * Gets a string of the options that change the generated code, e.g. for keying cached compilations.
+     * Every such option must be added here. The remarks are left out, since they do not change the code.
+     */
+    inline std::string key() const
+    {
+        return std::to_string(fast_math) + std::to_string(vectorize) + std::to_string(unroll_loops) + ","
+            + std::to_string(unroll_count) + "," + std::to_string(whole_program) + std::to_string(bounds_check);
+    }
+};
@@ -1,11 +1,30 @@
 #include <algorithm>
 #include <iostream>
 #include <tuple>
+#include <map>
+#include <limits>
+#include <charconv>
 #include "Span.hpp"
 #include "Operator.hpp"
 #include "Error.hpp"
 #include "Parser.hpp"
 
+/**
+ * Converts the digits of the integer token to a number, ignoring any suffix. Throws an error if the number is greater
+ * than the maximum, rather than wrapping it.
+ */
+static unsigned long parse_integer(const Token& token, unsigned long max = std::numeric_limits<unsigned long>::max())
+{
+    unsigned long value = 0;
+    auto result = std::from_chars(token.value.data(), token.value.data() + token.value.size(), value);
+    if (result.ec == std::errc::result_out_of_range || value > max)
+    {
+        throw Error(token.span, "Error", "integer constant " + token.value + " is too large");
+    }
+
+    return value;
+}
+
 /**
  * Parses the program and retunrs the abstract syntax tree.
  */
@@ -38,29 +57,33 @@ std::shared_ptr<Program> Parser::parse()
 }
 
 /**
- * Determines if the next 3 lookahead tokens match a function.
+ * Determines if the lookahead tokens match a function, i.e. an optional extern, a type, an identifier, and a (.
  * TODO will need to update once pointer types are allowed.
  */
 bool Parser::lookahead_is_function()
 {
-    if (is_currently({ "void", "int" }))
+    auto i = index;
+    if (i < lexer.size() && lexer[i].type == "extern")
     {
-        if (index+2 < lexer.size() && lexer[index+1].type == TokenType_Id && lexer[index+2].type == "(")
-        {
-            return true;
-        }
+        i++;
     }
 
-    if (is_currently({ "extern" }))
+    auto is_type_keyword = [&](std::size_t i)
     {
-        if (index+3 < lexer.size() && (lexer[index+1].type == "void" || lexer[index+1].type == "int") && 
-            lexer[index+2].type == TokenType_Id && lexer[index+3].type == "(")
-        {
-            return true;
-        }
+        return i < lexer.size() && std::find(type_keywords.begin(), type_keywords.end(), lexer[i].type) != type_keywords.end();
+    };
+
+    if (!is_type_keyword(i))
+    {
+        return false;
     }
 
-    return false;
+    while (is_type_keyword(i))
+    {
+        i++;
+    }
+
+    return i+1 < lexer.size() && lexer[i].type == TokenType_Id && lexer[i+1].type == "(";
 }
 
 /**
@@ -89,7 +112,7 @@ std::shared_ptr<FunctionDef> Parser::parse_function(ParserContext& context)
     {
         match("void");
     }
-    else if (is_currently({ "int" }))
+    else if (is_currently(type_keywords))
     {
         auto param = parse_parameter(context);
         params.push_back(param);
@@ -158,9 +181,16 @@ std::shared_ptr<Symbol> Parser::parse_parameter(ParserContext& context)
     if (is_currently({ "[" }))
     {
         match("[");
+        // C99 lets the qualifiers of the pointer go in the brackets, e.g. int a[restrict]
+        auto is_restrict = is_currently({ "restrict" });
+        if (is_restrict)
+        {
+            match("restrict");
+        }
+
         if (is_currently({ TokenType_Int }))
         {
-            auto array_size = std::stoi(match(TokenType_Int).value);
+            auto array_size = (int)parse_integer(match(TokenType_Int), std::numeric_limits<int>::max());
             match("]");
             symbol->type = std::make_shared<Type>(TypeType::Pointer, symbol->type, array_size);
         }
@@ -169,6 +199,8 @@ std::shared_ptr<Symbol> Parser::parse_parameter(ParserContext& context)
             match("]");
             symbol->type = std::make_shared<Type>(TypeType::Pointer, symbol->type);
         }
+
+        symbol->type->is_restrict = is_restrict;
     }
 
     return symbol;
@@ -187,7 +219,7 @@ std::shared_ptr<GlobalDeclaration> Parser::parse_global_declaration(ParserContex
     if (is_currently({ "[" }))
     {
         match("[");
-        auto array_size = std::stoi(match(TokenType_Int).value);
+        auto array_size = (int)parse_integer(match(TokenType_Int), std::numeric_limits<int>::max());
         match("]");
 
         symbol->type = std::make_shared<Type>(TypeType::Array, symbol->type, array_size);
@@ -203,7 +235,7 @@ std::shared_ptr<GlobalDeclaration> Parser::parse_global_declaration(ParserContex
  */
 std::shared_ptr<Statement> Parser::parse_statement(ParserContext& context)
 {
-    if (is_currently({ "void", "int" }))
+    if (is_currently(type_keywords))
     {
         return parse_variable_declaration(context);
     }
@@ -219,6 +251,18 @@ std::shared_ptr<Statement> Parser::parse_statement(ParserContext& context)
     {
         return parse_for_loop(context);
     }
+    else if (is_currently({ TokenType_Unroll }))
+    {
+        return parse_unrolled_loop(context);
+    }
+    else if (is_currently({ "switch" }))
+    {
+        return parse_switch_statement(context);
+    }
+    else if (is_currently({ "break" }))
+    {
+        return parse_break_statement(context);
+    }
     else if (is_currently({ "return" }))
     {
         return parse_return_statement(context);
@@ -227,7 +271,7 @@ std::shared_ptr<Statement> Parser::parse_statement(ParserContext& context)
     {
         return parse_compound_statement(context);
     }
-    else if (is_currently({ TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" }))
+    else if (is_currently({ TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
     {
         auto statement = parse_expression(context);
         auto token = match(";");
@@ -236,7 +280,7 @@ std::shared_ptr<Statement> Parser::parse_statement(ParserContext& context)
     }
     else
     {
-        throw ParseError(current(), { "void", "int", "if", "while", "for", "return", "{", TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" });
+        throw ParseError(current(), { "void", "int", "if", "while", "for", "switch", "break", "return", "{", TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" });
     }
 }
 
@@ -250,7 +294,7 @@ std::shared_ptr<CompoundStatement> Parser::parse_compound_statement(ParserContex
     Span span = current().span;
     match("{");
     std::vector<std::shared_ptr<Statement>> statements;
-    while (is_currently({ "void", "int", "if",  "while", "for", "return", "{", TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" }))
+    while (is_currently(type_keywords) || is_currently({ "if",  "while", "for", TokenType_Unroll, "switch", "break", "return", "{", TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
     {
         statements.push_back(parse_statement(context));
     }
@@ -279,7 +323,7 @@ std::shared_ptr<VariableDeclaration> Parser::parse_variable_declaration(ParserCo
         if (is_currently({ "[" }))
         {
             match("[");
-            auto array_size = std::stoi(match(TokenType_Int).value);
+            auto array_size = (int)parse_integer(match(TokenType_Int), std::numeric_limits<int>::max());
             match("]");
 
             symbol->type = std::make_shared<Type>(TypeType::Array, symbol->type, array_size);
@@ -348,7 +392,9 @@ std::shared_ptr<WhileLoop> Parser::parse_while_loop(ParserContext& context)
     match("(");
     auto guard = parse_expression(context);
     match (")");
+    context.breakable_depth++;
     auto body = parse_statement(context);
+    context.breakable_depth--;
     span += body->span;
     return std::make_shared<WhileLoop>(span, guard, body, context.current_symbol_table());
 }
@@ -365,29 +411,135 @@ std::shared_ptr<ForLoop> Parser::parse_for_loop(ParserContext& context)
     std::shared_ptr<Expression> init = nullptr;
     std::shared_ptr<Expression> guard = nullptr;
     std::shared_ptr<Expression> update = nullptr;
-    if (is_currently({ TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" }))
+    if (is_currently({ TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
     {
         init = parse_expression(context);
     }
 
     match(";");
-    if (is_currently({ TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" }))
+    if (is_currently({ TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
     {
         guard = parse_expression(context);
     }
 
     match(";");
-    if (is_currently({ TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" }))
+    if (is_currently({ TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
     {
         update = parse_expression(context);
     }
 
     match (")");
+    context.breakable_depth++;
     auto body = parse_statement(context);
+    context.breakable_depth--;
     span += body->span;
     return std::make_shared<ForLoop>(span, init, guard, update, body, context.current_symbol_table());
 }
 
+/**
+ * Parses a loop that follows a #pragma unroll. Without a count the loop is fully unrolled if possible,
+ * which is recorded as a count of 0.
+ */
+std::shared_ptr<Statement> Parser::parse_unrolled_loop(ParserContext& context)
+{
+    auto pragma = match(TokenType_Unroll);
+    auto count = pragma.value.empty() ? 0 : std::max(1, (int)parse_integer(pragma, std::numeric_limits<int>::max()));
+    if (is_currently({ "for" }))
+    {
+        auto loop = parse_for_loop(context);
+        loop->unroll = count;
+        return loop;
+    }
+    else if (is_currently({ "while" }))
+    {
+        auto loop = parse_while_loop(context);
+        loop->unroll = count;
+        return loop;
+    }
+    else
+    {
+        throw ParseError(current(), { "for", "while" });
+    }
+}
+
+/**
+ * Parses a switch statement.
+ */
+std::shared_ptr<SwitchStatement> Parser::parse_switch_statement(ParserContext& context)
+{
+    Span span = current().span;
+    match("switch");
+    match("(");
+    auto guard = parse_expression(context);
+    match(")");
+
+    context.push_symbol_table();
+    context.breakable_depth++;
+    match("{");
+
+    std::vector<SwitchCase> cases;
+    while (is_currently({ "case", "default" }))
+    {
+        Span case_span = current().span;
+        std::optional<long> value;
+        if (is_currently({ "case" }))
+        {
+            match("case");
+            bool is_negative = false;
+            if (is_currently({ "-" }))
+            {
+                match("-");
+                is_negative = true;
+            }
+
+            auto value_token = match(TokenType_Int);
+            auto magnitude = parse_integer(value_token);
+            value = (long)(is_negative ? 0 - magnitude : magnitude);
+        }
+        else
+        {
+            match("default");
+        }
+
+        case_span += match(":").span;
+
+        std::vector<std::shared_ptr<Statement>> statements;
+        while (is_currently(type_keywords) || is_currently({ "if",  "while", "for", TokenType_Unroll, "switch", "break", "return", "{", TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
+        {
+            auto statement = parse_statement(context);
+            case_span += statement->span;
+            statements.push_back(statement);
+        }
+
+        cases.push_back(SwitchCase(case_span, value, statements));
+    }
+
+    auto token = match("}");
+    span += token.span;
+    context.breakable_depth--;
+
+    auto symbol_table = context.current_symbol_table();
+    context.pop_symbol_table();
+    return std::make_shared<SwitchStatement>(span, guard, cases, symbol_table);
+}
+
+/**
+ * Parses a break statement.
+ */
+std::shared_ptr<Break> Parser::parse_break_statement(ParserContext& context)
+{
+    Span span = current().span;
+    match("break");
+    if (context.breakable_depth == 0)
+    {
+        throw Error(span, "Error", "break statement not within a loop or switch");
+    }
+
+    auto token = match(";");
+    span += token.span;
+    return std::make_shared<Break>(span, context.current_symbol_table());
+}
+
 /**
  * Parses a return statement.
  */
@@ -395,7 +547,7 @@ std::shared_ptr<Return> Parser::parse_return_statement(ParserContext& context)
 {
     Span span = current().span;
     match("return");
-    if (is_currently({ TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" }))
+    if (is_currently({ TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
     {
         auto expr = parse_expression(context);
         auto token = match(";");
@@ -466,14 +618,25 @@ std::shared_ptr<Expression> Parser::parse_expression(ParserContext& context, int
 std::shared_ptr<Expression> Parser::parse_unary(ParserContext& context) // TODO may need to change to get operator precedence right
 {
     Span span = current().span;
-    if (is_currently({ "-", "!", "*", "&", "++", "--" }))
+    if (is_currently({ "(" }) && index+1 < lexer.size() && 
+        std::find(type_keywords.begin(), type_keywords.end(), lexer[index+1].type) != type_keywords.end())
+    {
+        // a cast expression
+        match("(");
+        auto type = parse_type(context);
+        match(")");
+        auto expr = parse_unary(context);
+        span += expr->span;
+        return std::make_shared<TypeCast>(span, expr, type, context.current_symbol_table());
+    }
+    else if (is_currently({ "-", "!", "~", "*", "&", "++", "--" }))
     {
-        auto op = match({ "-", "!", "*", "&", "++", "--" });
+        auto op = match({ "-", "!", "~", "*", "&", "++", "--" });
         auto expr = parse_term(context);
         span += expr->span;
         return std::make_shared<UnaryOperation>(span, get_UnOp(op.value), expr, context.current_symbol_table());
     }
-    else if (is_currently({ TokenType_Int, TokenType_Id, "(" }))
+    else if (is_currently({ TokenType_Int, TokenType_Float, TokenType_Id, "(" }))
     {
         auto term = parse_term(context);
         if (is_currently({ "++", "--" }))
@@ -496,7 +659,7 @@ std::shared_ptr<Expression> Parser::parse_unary(ParserContext& context) // TODO
         }
     }
 
-    throw ParseError(current(), { "-",  "!", "*", "&", "++", "--", TokenType_Int, TokenType_Id, "(" });
+    throw ParseError(current(), { "-",  "!", "~", "*", "&", "++", "--", TokenType_Int, TokenType_Float, TokenType_Id, "(" });
 }
 
 /**
@@ -507,7 +670,18 @@ std::shared_ptr<Expression> Parser::parse_term(ParserContext& context)
     if (is_currently({ TokenType_Int }))
     {
         auto token = match(TokenType_Int);
-        return std::make_shared<IntegerConstant>(token.span, std::stol(token.value), context.current_symbol_table());
+        auto suffix = token.value.substr(std::min(token.value.find_first_of(integer_suffix_chars), token.value.size()));
+        auto constant = std::make_shared<IntegerConstant>(token.span, (long)parse_integer(token), context.current_symbol_table());
+        constant->is_unsigned = suffix.find_first_of("uU") != std::string::npos;
+        constant->is_long = suffix.find_first_of("lL") != std::string::npos;
+        return constant;
+    }
+    else if (is_currently({ TokenType_Float }))
+    {
+        auto token = match(TokenType_Float);
+        auto constant = std::make_shared<FloatConstant>(token.span, std::stod(token.value), context.current_symbol_table());
+        constant->is_float = token.value.find_first_of("fF") != std::string::npos;
+        return constant;
     }
     else if (is_currently({ TokenType_Id }))
     {
@@ -518,7 +692,7 @@ std::shared_ptr<Expression> Parser::parse_term(ParserContext& context)
             match("(");
 
             std::vector<std::shared_ptr<Expression>> args;
-            if (is_currently({ TokenType_Int, TokenType_Id, "(", "-", "!", "*", "&", "++", "--" }))
+            if (is_currently({ TokenType_Int, TokenType_Float, TokenType_Id, "(", "-", "!", "~", "*", "&", "++", "--" }))
             {
                 args.push_back(parse_expression(context));
                 while (is_currently({ "," }))
@@ -547,7 +721,7 @@ std::shared_ptr<Expression> Parser::parse_term(ParserContext& context)
 
     // TODO add parens, function calls, arrays, etc
 
-    throw ParseError(current(), { TokenType_Int, TokenType_Id, "(" });
+    throw ParseError(current(), { TokenType_Int, TokenType_Float, TokenType_Id, "(" });
 }
 
 /**
@@ -560,13 +734,83 @@ std::shared_ptr<Type> Parser::parse_type(ParserContext& context)
         match("void");
         return std::make_shared<Type>(TypeType::Void);
     }
+    else if (is_currently({ "float" }))
+    {
+        match("float");
+        return std::make_shared<Type>(TypeType::Float);
+    }
+    else if (is_currently({ "double" }))
+    {
+        match("double");
+        return std::make_shared<Type>(TypeType::Double);
+    }
+
+    // the fixed width integer types from stdint.h, and size_t from stddef.h
+    static const std::map<std::string, std::pair<TypeType, bool>> fixed_width_types = {
+        { "int8_t", { TypeType::Char, false } }, { "uint8_t", { TypeType::Char, true } },
+        { "int16_t", { TypeType::Short, false } }, { "uint16_t", { TypeType::Short, true } },
+        { "int32_t", { TypeType::Int, false } }, { "uint32_t", { TypeType::Int, true } },
+        { "int64_t", { TypeType::Long, false } }, { "uint64_t", { TypeType::Long, true } },
+        { "size_t", { TypeType::Long, true } },
+    };
+
+    auto it = fixed_width_types.find(current().type);
+    if (it != fixed_width_types.end())
+    {
+        match(it->first);
+        return std::make_shared<Type>(it->second.first, it->second.second);
+    }
+
+    bool is_unsigned = false;
+    bool has_sign = false;
+    if (is_currently({ "signed", "unsigned" }))
+    {
+        is_unsigned = match({ "signed", "unsigned" }).type == "unsigned";
+        has_sign = true;
+    }
+
+    if (is_currently({ "char" }))
+    {
+        match("char");
+        return std::make_shared<Type>(TypeType::Char, is_unsigned);
+    }
+    else if (is_currently({ "short" }))
+    {
+        match("short");
+        if (is_currently({ "int" }))
+        {
+            match("int");
+        }
+
+        return std::make_shared<Type>(TypeType::Short, is_unsigned);
+    }
+    else if (is_currently({ "long" }))
+    {
+        // long and long long are both 64 bits
+        match("long");
+        if (is_currently({ "long" }))
+        {
+            match("long");
+        }
+
+        if (is_currently({ "int" }))
+        {
+            match("int");
+        }
+
+        return std::make_shared<Type>(TypeType::Long, is_unsigned);
+    }
     else if (is_currently({ "int" }))
     {
         match("int");
-        return std::make_shared<Type>(TypeType::Int);
+        return std::make_shared<Type>(TypeType::Int, is_unsigned);
+    }
+    else if (has_sign)
+    {
+        return std::make_shared<Type>(TypeType::Int, is_unsigned);
     }
     
-    throw ParseError(current(), { "void", "int" });
+    throw ParseError(current(), type_keywords);
 }
 
 /**
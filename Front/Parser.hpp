@@ -36,6 +36,7 @@ private:
 
     public:
         std::shared_ptr<SymbolTable> global_symbol_table;
+        int breakable_depth = 0; // number of enclosing loops and switches
 
         ParserContext()
         {
@@ -57,6 +58,9 @@ private:
     std::shared_ptr<IfStatement> parse_if_statement(ParserContext& context);
     std::shared_ptr<WhileLoop> parse_while_loop(ParserContext& context);
     std::shared_ptr<ForLoop> parse_for_loop(ParserContext& context);
+    std::shared_ptr<Statement> parse_unrolled_loop(ParserContext& context);
+    std::shared_ptr<SwitchStatement> parse_switch_statement(ParserContext& context);
+    std::shared_ptr<Break> parse_break_statement(ParserContext& context);
     std::shared_ptr<Return> parse_return_statement(ParserContext& context);
     std::shared_ptr<Expression> parse_expression(ParserContext& context);
     std::shared_ptr<Expression> parse_expression(ParserContext& context, int p);
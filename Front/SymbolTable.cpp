@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 #include "Error.hpp"
 #include "SymbolTable.hpp"
 
@@ -120,3 +121,33 @@ std::shared_ptr<Symbol> SymbolTable::new_temp(std::shared_ptr<Type> type)
     temps.push_back(temp);
     return temp;
 }
+
+/**
+ * Creates a compiler generated variable and adds it to the symbol table. Unlike a temporary, 
+ * the variable lives in memory, so it can be assigned in more than one basic block.
+ */
+std::shared_ptr<Symbol> SymbolTable::new_variable(std::shared_ptr<Type> type)
+{
+    auto name = "v." +  std::to_string(temp_count);
+    temp_count++;
+    return add_symbol(name, type);
+}
+
+/**
+ * Removes the temporary variables in dead from this symbol table and all of its children recursively.
+ */
+void SymbolTable::remove_temps(const std::set<Symbol *>& dead)
+{
+    auto is_dead = [&](std::shared_ptr<Symbol>& symbol) { return dead.find(symbol.get()) != dead.end(); };
+
+    temps.erase(std::remove_if(temps.begin(), temps.end(), is_dead), temps.end());
+    for (auto it = table.begin(); it != table.end();)
+    {
+        it = is_dead(it->second) ? table.erase(it) : std::next(it);
+    }
+
+    for (auto child : children)
+    {
+        child->remove_temps(dead);
+    }
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <set>
 #include "Lexer.hpp"
 #include "Type.hpp"
 #include "CodegenSymbolData.hpp"
@@ -31,6 +32,7 @@ public:
     Symbol(std::string name, std::shared_ptr<Type> type, int scope): name(name), type(type), scope(scope) {}
 
     std::string get_name();
+    inline std::string get_source_name() { return name; }
 };
 
 /**
@@ -64,4 +66,6 @@ public:
     std::vector<std::shared_ptr<Symbol>> get_all_variables();
 
     std::shared_ptr<Symbol> new_temp(std::shared_ptr<Type> type);
+    std::shared_ptr<Symbol> new_variable(std::shared_ptr<Type> type);
+    void remove_temps(const std::set<Symbol *>& dead);
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <set>
 #include "Operator.hpp"
 #include "Error.hpp"
 #include "SyntaxTree.hpp"
@@ -8,7 +9,10 @@
 /*                             Type Check                                       */
 /********************************************************************************/
 
-static bool try_typecast(std::shared_ptr<Expression> e, std::shared_ptr<Type> type);
+static bool try_typecast(std::shared_ptr<Expression>& e, std::shared_ptr<Type> type);
+static std::shared_ptr<Type> get_promoted_type(std::shared_ptr<Type> type);
+static long convert_integer(long value, std::shared_ptr<Type> type);
+static std::shared_ptr<Type> get_common_type(std::shared_ptr<Type> type1, std::shared_ptr<Type> type2);
 
 /**
  * Typechecks the compound statement.
@@ -103,6 +107,56 @@ void ForLoop::typecheck(TypecheckContext& context)
     body->typecheck(context);
 }
 
+/**
+ * Typechecks the switch statement.
+ */
+void SwitchStatement::typecheck(TypecheckContext& context)
+{
+    guard->typecheck(context);
+    if (!guard->type->is_integer())
+    {
+        throw TypeError(guard->span, "switch quantity is not an integer");
+    }
+
+    // the guard is promoted as in C, and the case values are converted to its promoted type, so e.g. 1 and 257 are
+    // different cases of a char guard, and 257 never matches
+    try_typecast(guard, get_promoted_type(guard->type));
+
+    std::set<long> values;
+    bool has_default = false;
+    for (auto& c : cases)
+    {
+        if (c.value)
+        {
+            c.value = convert_integer(c.value.value(), guard->type);
+            if (!values.insert(c.value.value()).second)
+            {
+                throw TypeError(c.span, "duplicate case value " + std::to_string(c.value.value()));
+            }
+        }
+        else if (has_default)
+        {
+            throw Error(c.span, "Error", "multiple default labels in one switch");
+        }
+        else
+        {
+            has_default = true;
+        }
+
+        for (auto& statement : c.statements)
+        {
+            statement->typecheck(context);
+        }
+    }
+}
+
+/**
+ * Typechecks the break statement.
+ */
+void Break::typecheck(TypecheckContext& context)
+{
+}
+
 /**
  * Typechecks the variable.
  */
@@ -141,15 +195,100 @@ void BinaryOperation::typecheck(TypecheckContext& context)
 {
     lhs->typecheck(context);
     rhs->typecheck(context);
-    //if (*lhs->type != *rhs->type || (lhs->type->type == TypeType::Pointer && rhs))
-    if (!try_typecast(rhs, lhs->type))
+
+    auto cast_operands = [&](std::shared_ptr<Type> lhs_type, std::shared_ptr<Type> rhs_type)
     {
-        // TODO implicitly cast type if possible
-        throw TypeError(span, "type mismatch between operands of binary operation");
-    }
-    else
+        if (!try_typecast(lhs, lhs_type) || !try_typecast(rhs, rhs_type))
+        {
+            throw TypeError(span, "type mismatch between operands of binary operation");
+        }
+    };
+
+    switch (op)
     {
-        type = lhs->type;
+        case BinOp::Equal:
+        case BinOp::NotEqual:
+        case BinOp::LessThan:
+        case BinOp::LessThanEqual:
+        case BinOp::GreaterThan:
+        case BinOp::GreaterThanEqual:
+        {
+            // compare in the common type, so the signedness of the comparison is known
+            auto common_type = get_common_type(lhs->type, rhs->type);
+            cast_operands(common_type, common_type);
+            type = std::make_shared<Type>(TypeType::Int);
+            break;
+        }
+        case BinOp::And:
+        case BinOp::Or:
+            // each operand is compared against zero on its own
+            type = std::make_shared<Type>(TypeType::Int);
+            break;
+        case BinOp::ShiftLeft:
+        case BinOp::ShiftRight:
+        {
+            if (!lhs->type->is_integer() || !rhs->type->is_integer())
+            {
+                throw TypeError(span, "invalid operands to shift operation");
+            }
+
+            // the result has the type of the promoted left operand
+            auto lhs_type = get_promoted_type(lhs->type);
+            cast_operands(lhs_type, lhs_type);
+            type = lhs_type;
+            break;
+        }
+        case BinOp::Modulo:
+        case BinOp::BitAnd:
+        case BinOp::BitOr:
+        case BinOp::BitXor:
+            if (lhs->type->is_floating() || rhs->type->is_floating())
+            {
+                throw TypeError(span, "invalid floating point operands to binary operation");
+            }
+            [[fallthrough]];
+        case BinOp::Plus:
+        case BinOp::Minus:
+        case BinOp::Times:
+        case BinOp::Divide:
+        {
+            auto common_type = get_common_type(lhs->type, rhs->type);
+            cast_operands(common_type, common_type);
+            type = common_type;
+            break;
+        }
+        case BinOp::ModuloAssign:
+        case BinOp::BitAndAssign:
+        case BinOp::BitOrAssign:
+        case BinOp::BitXorAssign:
+        case BinOp::ShiftLeftAssign:
+        case BinOp::ShiftRightAssign:
+            if (lhs->type->is_floating() || rhs->type->is_floating())
+            {
+                throw TypeError(span, "invalid floating point operands to binary operation");
+            }
+            [[fallthrough]];
+        case BinOp::PlusAssign:
+        case BinOp::MinusAssign:
+        case BinOp::TimesAssign:
+        case BinOp::DivideAssign:
+        {
+            // a op= b computes a op b as the operation does, then converts the result to the type of a to store it
+            auto is_shift = op == BinOp::ShiftLeftAssign || op == BinOp::ShiftRightAssign;
+            op_type = is_shift ? get_promoted_type(lhs->type) : get_common_type(lhs->type, rhs->type);
+            if (!try_typecast(rhs, op_type))
+            {
+                throw TypeError(span, "type mismatch between operands of binary operation");
+            }
+
+            type = lhs->type;
+            break;
+        }
+        default:
+            // assignments convert the value to the type of the left operand
+            cast_operands(lhs->type, lhs->type);
+            type = lhs->type;
+            break;
     }
 }
 
@@ -161,7 +300,16 @@ void UnaryOperation::typecheck(TypecheckContext& context)
     expr->typecheck(context);
     switch (op)
     {
+        case UnOp::BitNot:
+            if (expr->type->is_floating())
+            {
+                throw TypeError(span, "invalid floating point operand to unary operation");
+            }
+            [[fallthrough]];
         case UnOp::Negation:
+            try_typecast(expr, get_promoted_type(expr->type));
+            type = expr->type;
+            break;
         case UnOp::PlusPlus:
         case UnOp::MinusMinus:
             type = expr->type;
@@ -187,7 +335,7 @@ void ArrayIndex::typecheck(TypecheckContext& context)
     }
 
     index->typecheck(context);
-    if (index->type->type != TypeType::Int && index->type->type != TypeType::Char)
+    if (!index->type->is_integer())
     {
         throw TypeError(span, "invalid type for index");
     }
@@ -200,7 +348,29 @@ void ArrayIndex::typecheck(TypecheckContext& context)
  */
 void IntegerConstant::typecheck(TypecheckContext& context)
 {
-    type = std::make_shared<Type>(TypeType::Int);
+    // the constant is an int unless it has a long suffix or does not fit
+    bool fits_int = is_unsigned ? (unsigned long)value <= UINT32_MAX : value >= INT32_MIN && value <= INT32_MAX;
+    type = std::make_shared<Type>(is_long || !fits_int ? TypeType::Long : TypeType::Int, is_unsigned);
+}
+
+/**
+ * Typechecks the floating point constant.
+ */
+void FloatConstant::typecheck(TypecheckContext& context)
+{
+    type = std::make_shared<Type>(is_float ? TypeType::Float : TypeType::Double);
+}
+
+/**
+ * Typechecks the type cast.
+ */
+void TypeCast::typecheck(TypecheckContext& context)
+{
+    expr->typecheck(context);
+    if (!(expr->type->is_arithmetic() && type->is_arithmetic()) && *expr->type != *type)
+    {
+        throw TypeError(span, "invalid type cast");
+    }
 }
 
 /**
@@ -256,32 +426,40 @@ void Program::typecheck()
 }
 
 /**
- * Trys to typecast the type of e to the type.
+ * Trys to typecast the type of e to the type, replacing e with a type cast node if a conversion is needed.
  */
-static bool try_typecast(std::shared_ptr<Expression> e, std::shared_ptr<Type> type)
+static bool try_typecast(std::shared_ptr<Expression>& e, std::shared_ptr<Type> type)
 {
     if (*e->type == *type)
     {
         return true;
     }
 
-    auto typecast = [=] {
-        e->typecast = std::make_pair(e->type, type);
-        e->type = type;
+    auto typecast = [&] {
+        auto int_constant = std::dynamic_pointer_cast<IntegerConstant>(e);
+        auto float_constant = std::dynamic_pointer_cast<FloatConstant>(e);
+        if ((int_constant != nullptr && type->is_arithmetic()) || (float_constant != nullptr && type->is_floating()))
+        {
+            // constants are converted in place
+            e->type = type;
+        }
+        else
+        {
+            e = std::make_shared<TypeCast>(e->span, e, type, e->symbol_table);
+        }
+
         return true;
     };
 
     switch (type->type)
     {
         case TypeType::Int:
-            if (e->type->type == TypeType::Char)
-            {
-                return typecast();
-            }
-
-            return false;
         case TypeType::Char:
-            if (e->type->type == TypeType::Int)
+        case TypeType::Short:
+        case TypeType::Long:
+        case TypeType::Float:
+        case TypeType::Double:
+            if (e->type->is_arithmetic())
             {
                 return typecast();
             }
@@ -305,6 +483,73 @@ static bool try_typecast(std::shared_ptr<Expression> e, std::shared_ptr<Type> ty
     }
 }
 
+/**
+ * Gets the type after integer promotion, i.e. integer types smaller than int are promoted to int.
+ */
+static std::shared_ptr<Type> get_promoted_type(std::shared_ptr<Type> type)
+{
+    if (type->type == TypeType::Char || type->type == TypeType::Short)
+    {
+        return std::make_shared<Type>(TypeType::Int);
+    }
+
+    return type;
+}
+
+/**
+ * Converts the integer value to the integer type, wrapping it to the size of the type. The result is sign extended
+ * to a long if the type is signed and zero extended otherwise.
+ */
+static long convert_integer(long value, std::shared_ptr<Type> type)
+{
+    auto bits = type->size() * 8;
+    if (bits >= 64)
+    {
+        return value;
+    }
+
+    auto mask = (1UL << bits) - 1;
+    auto converted = (unsigned long)value & mask;
+    if (!type->is_unsigned && (converted >> (bits - 1)) != 0)
+    {
+        converted |= ~mask;
+    }
+
+    return (long)converted;
+}
+
+/**
+ * Gets the common type of the operands of an arithmetic operation, following the usual arithmetic conversions.
+ * Long can represent every unsigned int, so only operands of the same size are converted to unsigned.
+ */
+static std::shared_ptr<Type> get_common_type(std::shared_ptr<Type> type1, std::shared_ptr<Type> type2)
+{
+    if (!type1->is_arithmetic() || !type2->is_arithmetic())
+    {
+        return type1;
+    }
+
+    // a floating type wins over any integer type, and double wins over float
+    if (type1->is_floating() || type2->is_floating())
+    {
+        if (type1->is_floating() && type2->is_floating())
+        {
+            return type1->size() >= type2->size() ? type1 : type2;
+        }
+
+        return type1->is_floating() ? type1 : type2;
+    }
+
+    type1 = get_promoted_type(type1);
+    type2 = get_promoted_type(type2);
+    if (type1->size() != type2->size())
+    {
+        return type1->size() > type2->size() ? type1 : type2;
+    }
+
+    return type1->is_unsigned ? type1 : type2;
+}
+
 /********************************************************************************/
 /*                                   Dump                                       */
 /********************************************************************************/
@@ -325,6 +570,30 @@ void IntegerConstant::dump(int depth)
     std::cout << "IntegerConstant(" << value << ")";
 }
 
+/**
+ * Dumps the AST node.
+ */
+void FloatConstant::dump(int depth)
+{
+    std::cout << "FloatConstant(" << value << ")";
+}
+
+/**
+ * Dumps the AST node.
+ */
+void TypeCast::dump(int depth)
+{
+    std::cout << "TypeCast(\n";
+    indent(depth);
+    std::cout << "type = ";
+    type->dump();
+    std::cout << ",\n";
+    indent(depth);
+    std::cout << "expr = ";
+    expr->dump(depth);
+    std::cout << ")";
+}
+
 /**
  * Dumps the AST node.
  */
@@ -541,6 +810,13 @@ void WhileLoop::dump(int depth)
     std::cout << "body = ";
     body->dump(depth + 1);
 
+    if (unroll)
+    {
+        std::cout << "\n";
+        indent(depth);
+        std::cout << "unroll = " << unroll.value();
+    }
+
     std::cout << ")";
 }
 
@@ -591,9 +867,64 @@ void ForLoop::dump(int depth)
     std::cout << "body = ";
     body->dump(depth + 1);
 
+    if (unroll)
+    {
+        std::cout << "\n";
+        indent(depth);
+        std::cout << "unroll = " << unroll.value();
+    }
+
     std::cout << ")";
 }
 
+/**
+ * Dumps the AST node.
+ */
+void SwitchStatement::dump(int depth)
+{
+    std::cout << "SwitchStatement(\n";
+    indent(depth);
+    std::cout << "guard = ";
+    guard->dump(depth + 1);
+
+    for (auto& c : cases)
+    {
+        std::cout << ",\n";
+        indent(depth);
+        if (c.value)
+        {
+            std::cout << "case " << c.value.value() << " = (";
+        }
+        else
+        {
+            std::cout << "default = (";
+        }
+
+        for (auto i = 0; i < c.statements.size(); i++)
+        {
+            std::cout << "\n";
+            indent(depth + 1);
+            c.statements[i]->dump(depth + 2);
+            if (i < c.statements.size() - 1)
+            {
+                std::cout << ",";
+            }
+        }
+
+        std::cout << ")";
+    }
+
+    std::cout << ")";
+}
+
+/**
+ * Dumps the AST node.
+ */
+void Break::dump(int depth)
+{
+    std::cout << "Break()";
+}
+
 /**
  * Dumps the AST node.
  */
@@ -690,3 +1021,29 @@ void Program::ir_dump()
         std::cout << "\n";
     }
 }
+
+
+/**
+ * Dumps the size of the live sets of each basic block in the program.
+ */
+void Program::liveness_dump()
+{
+    for (auto f : functions)
+    {
+        if (f->is_proto())
+        {
+            continue;
+        }
+
+        std::cerr << f->function->get_name() << "\n";
+        for (auto i = 0; i < f->cfg.size(); i++)
+        {
+            auto& block = f->cfg[i];
+            std::cerr << "block " << i << ": live in = " << block->live_in.size() 
+                << ", live out = " << block->live_out.size() 
+                << ", max live = " << block->max_live << "\n";
+        }
+
+        std::cerr << "\n";
+    }
+}
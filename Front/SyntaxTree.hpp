@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <functional>
+#include <set>
 #include <vector>
 #include <memory>
 #include "Span.hpp"
@@ -9,6 +11,8 @@
 #include "Operator.hpp"
 #include "Quad.hpp"
 #include "CFG.hpp"
+#include "FunctionAttrs.hpp"
+#include "Options.hpp"
 
 struct FunctionDef;
 
@@ -28,7 +32,13 @@ public:
     std::shared_ptr<SymbolTable> symbol_table;
     QuadList ir_list;
 
-    SyntaxTree(Span span, std::shared_ptr<SymbolTable> symbol_table) : span(span), symbol_table(symbol_table) {}
+    /* the number of nodes created, for -fmem-report */
+    static inline long nodes_created = 0;
+
+    SyntaxTree(Span span, std::shared_ptr<SymbolTable> symbol_table) : span(span), symbol_table(symbol_table)
+    {
+        nodes_created++;
+    }
 
     virtual void typecheck(TypecheckContext& context) = 0;
     virtual void ir_codegen() = 0;
@@ -51,7 +61,6 @@ struct Expression : Statement
     std::shared_ptr<Type> type;
     std::shared_ptr<Operand> place;
     std::shared_ptr<Operand> location;
-    std::optional<std::pair<std::shared_ptr<Type>, std::shared_ptr<Type>>> typecast = {};
 
     QuadList ir_list_lval;
 
@@ -59,6 +68,7 @@ struct Expression : Statement
 
     virtual bool ir_codegen_lval();
     virtual void ir_codegen_bool(std::shared_ptr<Operand> true_label, std::shared_ptr<Operand> false_label);
+    virtual bool is_speculatable() { return false; }
 };
 
 /**
@@ -167,6 +177,9 @@ struct WhileLoop : Statement
     std::shared_ptr<Expression> guard;
     std::shared_ptr<Statement> body;
 
+    /* the count from #pragma unroll, or 0 to unroll fully */
+    std::optional<int> unroll;
+
     WhileLoop(Span span, std::shared_ptr<Expression> guard, std::shared_ptr<Statement> body, std::shared_ptr<SymbolTable> symbol_table) :
         Statement(span, symbol_table),
         guard(guard), 
@@ -188,6 +201,9 @@ struct ForLoop : Statement
     std::shared_ptr<Expression> update;
     std::shared_ptr<Statement> body;
 
+    /* the count from #pragma unroll, or 0 to unroll fully */
+    std::optional<int> unroll;
+
     ForLoop(Span span,
             std::shared_ptr<Expression> init_stmt, 
             std::shared_ptr<Expression> guard, 
@@ -206,6 +222,53 @@ struct ForLoop : Statement
     void dump(int depth = 1) override;
 };
 
+/**
+ * A case of a switch statement. The value is empty for the default case.
+ */
+struct SwitchCase
+{
+    Span span;
+    std::optional<long> value;
+    std::vector<std::shared_ptr<Statement>> statements;
+
+    SwitchCase(Span span, std::optional<long> value, std::vector<std::shared_ptr<Statement>> statements) :
+        span(span),
+        value(value),
+        statements(statements)
+    {}
+};
+
+/**
+ * The switch statement AST node.
+ */
+struct SwitchStatement : Statement
+{
+    std::shared_ptr<Expression> guard;
+    std::vector<SwitchCase> cases;
+
+    SwitchStatement(Span span, std::shared_ptr<Expression> guard, std::vector<SwitchCase> cases, std::shared_ptr<SymbolTable> symbol_table) :
+        Statement(span, symbol_table),
+        guard(guard),
+        cases(cases)
+    {}
+
+    void typecheck(TypecheckContext& context) override;
+    void ir_codegen() override;
+    void dump(int depth = 1) override;
+};
+
+/**
+ * The break statement AST node.
+ */
+struct Break : Statement
+{
+    Break(Span span, std::shared_ptr<SymbolTable> symbol_table) : Statement(span, symbol_table) {}
+
+    void typecheck(TypecheckContext& context) override;
+    void ir_codegen() override;
+    void dump(int depth = 1) override;
+};
+
 /**
  * The variable AST node.
  */
@@ -218,6 +281,7 @@ struct Variable : Expression
     void typecheck(TypecheckContext& context) override;
     void ir_codegen() override;
     bool ir_codegen_lval() override;
+    bool is_speculatable() override { return true; }
     void dump(int depth = 1) override;
 };
 
@@ -249,6 +313,9 @@ struct BinaryOperation : Expression
     std::shared_ptr<Expression> lhs;
     std::shared_ptr<Expression> rhs;
 
+    // the type a compound assignment computes in before its result is converted to the type of the left operand
+    std::shared_ptr<Type> op_type;
+
     BinaryOperation(Span span, BinOp op, std::shared_ptr<Expression> lhs, std::shared_ptr<Expression> rhs, std::shared_ptr<SymbolTable> symbol_table) :
         Expression(span, symbol_table),
         op(op),
@@ -259,6 +326,7 @@ struct BinaryOperation : Expression
     void typecheck(TypecheckContext& context) override;
     void ir_codegen() override;
     void ir_codegen_bool(std::shared_ptr<Operand> true_label, std::shared_ptr<Operand> false_label) override;
+    bool is_speculatable() override;
     void dump(int depth = 1) override;
 };
 
@@ -288,6 +356,7 @@ struct UnaryOperation : Expression
     void ir_codegen() override;
     bool ir_codegen_lval() override;
     void ir_codegen_bool(std::shared_ptr<Operand> true_label, std::shared_ptr<Operand> false_label) override;
+    bool is_speculatable() override;
     void dump(int depth = 1) override;
 };
 
@@ -312,17 +381,56 @@ struct ArrayIndex : Expression
     void dump(int depth = 1) override;
 };
 
+/**
+ * The type cast AST node. Created for explicit casts, and by the type checker for implicit conversions.
+ */
+struct TypeCast : Expression
+{
+    std::shared_ptr<Expression> expr;
+
+    TypeCast(Span span, std::shared_ptr<Expression> expr, std::shared_ptr<Type> type, std::shared_ptr<SymbolTable> symbol_table) :
+        Expression(span, symbol_table),
+        expr(expr)
+    {
+        this->type = type;
+    }
+
+    void typecheck(TypecheckContext& context) override;
+    void ir_codegen() override;
+    bool is_speculatable() override { return expr->is_speculatable(); }
+    void dump(int depth = 1) override;
+};
+
 /**
  * The integer constant AST node.
  */
 struct IntegerConstant : Expression
 {
     long value;
+    bool is_unsigned = false;
+    bool is_long = false;
 
     IntegerConstant(Span span, long value, std::shared_ptr<SymbolTable> symbol_table) : Expression(span, symbol_table), value(value) {}
 
     void typecheck(TypecheckContext& context) override;
     void ir_codegen() override;
+    bool is_speculatable() override { return true; }
+    void dump(int depth = 1) override;
+};
+
+/**
+ * The floating point constant AST node.
+ */
+struct FloatConstant : Expression
+{
+    double value;
+    bool is_float = false;
+
+    FloatConstant(Span span, double value, std::shared_ptr<SymbolTable> symbol_table) : Expression(span, symbol_table), value(value) {}
+
+    void typecheck(TypecheckContext& context) override;
+    void ir_codegen() override;
+    bool is_speculatable() override { return true; }
     void dump(int depth = 1) override;
 };
 
@@ -337,6 +445,7 @@ struct CharConstant : Expression
 
     void typecheck(TypecheckContext& context) override;
     void ir_codegen() override;
+    bool is_speculatable() override { return true; }
     void dump(int depth = 1) override;
 };
 
@@ -350,6 +459,8 @@ struct FunctionDef : SyntaxTree
     std::shared_ptr<CompoundStatement> body;
 
     std::vector<std::shared_ptr<BasicBlock>> cfg;
+    FunctionAttributes attributes;
+    std::optional<Effects> cached_effects;    // for a function loaded from the compile cache, whose quads are not optimized
 
     FunctionDef(Span span, std::shared_ptr<Symbol> function, std::vector<std::shared_ptr<Symbol>> params, std::shared_ptr<CompoundStatement> body, std::shared_ptr<SymbolTable> symbol_table):
         SyntaxTree(span, symbol_table),
@@ -367,6 +478,7 @@ struct FunctionDef : SyntaxTree
 
     void typecheck(TypecheckContext& context) override;
     void ir_codegen() override;
+    void ir_optimize(const Options& options = Options());
     void dump(int depth = 1) override;
 
     inline bool is_proto() { return body == nullptr; }
@@ -389,6 +501,8 @@ struct Program : SyntaxTree
     void typecheck(TypecheckContext& context) override;
     void typecheck();
     void ir_codegen() override;
+    void ir_optimize(const Options& options = Options(), const std::function<std::set<FunctionDef *>(std::vector<std::shared_ptr<FunctionDef>>&)>& find_cached = nullptr);
     void dump(int depth = 1) override;
     void ir_dump();
+    void liveness_dump();
 };
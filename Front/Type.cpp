@@ -1,4 +1,6 @@
 #include <iostream>
+#include <cassert>
+#include <climits>
 #include "Type.hpp"
 
 /**
@@ -14,16 +16,55 @@ int Type::size()
             return 4;
         case TypeType::Char:
                 return 1;
+        case TypeType::Short:
+            return 2;
+        case TypeType::Long:
+            return 8;
+        case TypeType::Float:
+            return 4;
+        case TypeType::Double:
+            return 8;
+        case TypeType::Vector:
+            return elem_type->size() * num_elems.value();
         default:
             return 0; // TODO handle other types later
     }
 }
 
+/**
+ * Gets the smallest value of an integer type. The range of unsigned long is limited to the values of a long.
+ */
+long Type::min_value()
+{
+    assert(is_integer());
+    if (is_unsigned)
+    {
+        return 0;
+    }
+
+    return size() < 8 ? -(1L << (8 * size() - 1)) : LONG_MIN;
+}
+
+/**
+ * Gets the largest value of an integer type. The range of unsigned long is limited to the values of a long.
+ */
+long Type::max_value()
+{
+    assert(is_integer());
+    auto bits = 8 * size() - (is_unsigned ? 0 : 1);
+    return bits < 63 ? (1L << bits) - 1 : LONG_MAX;
+}
+
 /**
  * Dumps the type.
  */
 void Type::dump()
 {
+    if (is_unsigned && is_integer())
+    {
+        std::cerr << "unsigned ";
+    }
+
     switch (type)
     {
         case TypeType::Void:
@@ -35,6 +76,18 @@ void Type::dump()
         case TypeType::Char:
             std::cerr << "char";
             break;
+        case TypeType::Short:
+            std::cerr << "short";
+            break;
+        case TypeType::Long:
+            std::cerr << "long";
+            break;
+        case TypeType::Float:
+            std::cerr << "float";
+            break;
+        case TypeType::Double:
+            std::cerr << "double";
+            break;
         case TypeType::Function:
             std::cerr << "(";
             for (auto i = 0; i < param_types.size(); i++)
@@ -58,5 +111,10 @@ void Type::dump()
             elem_type->dump();
             std::cerr << "*";
             break;
+        case TypeType::Vector:
+            std::cerr << "<" << num_elems.value() << " x ";
+            elem_type->dump();
+            std::cerr << ">";
+            break;
     }
 }
\ No newline at end of file
@@ -12,9 +12,14 @@ enum class TypeType
     Void,
     Int,
     Char,
+    Short,
+    Long,
+    Float,
+    Double,
     Function,
     Array,
-    Pointer
+    Pointer,
+    Vector
 };
 
 /**
@@ -23,11 +28,17 @@ enum class TypeType
 struct Type
 {
     TypeType type;
+
+    /* for integer types, and vector types of integers */
+    bool is_unsigned = false;
     
-    /* for array and pointer types */
+    /* for array, pointer and vector types */
     std::shared_ptr<Type> elem_type;
     std::optional<int> num_elems;
 
+    /* for pointer types, whether the pointer is declared restrict, i.e. the memory it accesses is not accessed through other pointers */
+    bool is_restrict = false;
+
     /* for function types */
     std::shared_ptr<Type> ret_type;
     std::vector<std::shared_ptr<Type>> param_types;
@@ -35,6 +46,7 @@ struct Type
     bool is_defined;
 
     Type(TypeType type) : type(type) {}
+    Type(TypeType type, bool is_unsigned) : type(type), is_unsigned(is_unsigned) {}
     Type(TypeType type, std::shared_ptr<Type> ret_type, std::vector<std::shared_ptr<Type>> param_types, bool is_extern, bool is_defined) : 
         type(type), 
         ret_type(ret_type),
@@ -50,9 +62,14 @@ struct Type
         switch (type)
         {
             case TypeType::Void:
+            case TypeType::Float:
+            case TypeType::Double:
+                return type == other.type;
             case TypeType::Int:
             case TypeType::Char:
-                return type == other.type;
+            case TypeType::Short:
+            case TypeType::Long:
+                return type == other.type && is_unsigned == other.is_unsigned;
             case TypeType::Function:
                 if (type != other.type || *ret_type != *ret_type || param_types.size() != other.param_types.size())
                 {
@@ -76,11 +93,19 @@ struct Type
                 }
 
                 return *elem_type == *other.elem_type;
+            case TypeType::Vector:
+                return type == other.type && num_elems == other.num_elems && *elem_type == *other.elem_type;
         }
     }
 
     bool operator!= (const Type& other) { return !operator==(other); }
 
+    inline bool is_integer() { return type == TypeType::Int || type == TypeType::Char || type == TypeType::Short || type == TypeType::Long; }
+    inline bool is_floating() { return type == TypeType::Float || type == TypeType::Double; }
+    inline bool is_arithmetic() { return is_integer() || is_floating(); }
+
     int size();
+    long min_value();
+    long max_value();
     void dump();
 };
@@ -0,0 +1,378 @@
+#include <map>
+#include <set>
+#include <optional>
+#include <climits>
+#include <algorithm>
+#include "Loop.hpp"
+#include "BoundsCheck.hpp"
+
+// how far the range analysis follows the definitions of temps
+const int max_depth = 16;
+
+/**
+ * An inclusive range of integer values.
+ */
+struct Range
+{
+    long lo;
+    long hi;
+
+    Range(long lo, long hi) : lo(lo), hi(hi) {}
+
+    inline bool within(long size) const { return lo >= 0 && hi < size; }
+};
+
+/**
+ * Finds the quad in the block that defines the temp, or nullptr if it is defined elsewhere.
+ */
+static std::shared_ptr<Quad> find_def(std::shared_ptr<Symbol> temp, std::shared_ptr<BasicBlock> block)
+{
+    for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+    {
+        auto def = quad->def();
+        if (def != nullptr && def->symbol == temp)
+        {
+            return quad;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * Computes the range of values of the integer operands used by quads, from the constants and operations that produce
+ * them and from the induction variables of counted loops.
+ */
+class RangeAnalysis
+{
+private:
+    std::shared_ptr<BasicBlock> block;
+
+    /* the quads of the counted loop bodies, before the induction variable is updated */
+    std::map<Quad *, Loop *>& loop_of;
+
+    static Range full_range(std::shared_ptr<Type> type)
+    {
+        return type->is_integer() ? Range(type->min_value(), type->max_value()) : Range(LONG_MIN, LONG_MAX);
+    }
+
+    /**
+     * Gets the range of a result, or the full range of its type if the value could have wrapped around.
+     */
+    static Range clamp(__int128 lo, __int128 hi, std::shared_ptr<Type> type)
+    {
+        auto range = full_range(type);
+        if (lo < range.lo || hi > range.hi)
+        {
+            return range;
+        }
+
+        return Range(lo, hi);
+    }
+
+    /**
+     * Gets the range of the value a quad in the block writes.
+     */
+    Range def_range(std::shared_ptr<Quad> def, int depth)
+    {
+        auto type = def->res->symbol->type;
+        switch (def->op)
+        {
+            case QuadOp::Copy:
+                return range(def->arg1, def, depth);
+            case QuadOp::Cast:
+            {
+                auto arg = range(def->arg1, def, depth);
+                return clamp(arg.lo, arg.hi, type);
+            }
+            case QuadOp::Add:
+            {
+                auto a = range(def->arg1, def, depth);
+                auto b = range(def->arg2, def, depth);
+                return clamp((__int128)a.lo + b.lo, (__int128)a.hi + b.hi, type);
+            }
+            case QuadOp::Sub:
+            {
+                auto a = range(def->arg1, def, depth);
+                auto b = range(def->arg2, def, depth);
+                return clamp((__int128)a.lo - b.hi, (__int128)a.hi - b.lo, type);
+            }
+            case QuadOp::Mul:
+            {
+                auto a = range(def->arg1, def, depth);
+                auto b = range(def->arg2, def, depth);
+                __int128 products[] = { (__int128)a.lo * b.lo, (__int128)a.lo * b.hi, (__int128)a.hi * b.lo, (__int128)a.hi * b.hi };
+                return clamp(*std::min_element(products, products + 4), *std::max_element(products, products + 4), type);
+            }
+            case QuadOp::BitAnd:
+            {
+                // masking with a non-negative value gives a value between 0 and the mask
+                auto a = range(def->arg1, def, depth);
+                auto b = range(def->arg2, def, depth);
+                if (a.lo >= 0 || b.lo >= 0)
+                {
+                    auto hi = a.lo >= 0 && b.lo >= 0 ? std::min(a.hi, b.hi) : (a.lo >= 0 ? a.hi : b.hi);
+                    return Range(0, hi);
+                }
+
+                break;
+            }
+            case QuadOp::Mod:
+            case QuadOp::Div:
+            case QuadOp::Shr:
+            case QuadOp::Shl:
+            {
+                auto a = range(def->arg1, def, depth);
+                auto b = range(def->arg2, def, depth);
+                if (a.lo < 0 || b.lo != b.hi || b.lo <= 0 || (def->op != QuadOp::Mod && def->op != QuadOp::Div && b.lo >= 63))
+                {
+                    break;
+                }
+                else if (def->op == QuadOp::Mod)
+                {
+                    return Range(0, std::min(a.hi, b.lo - 1));
+                }
+                else if (def->op == QuadOp::Div)
+                {
+                    return Range(a.lo / b.lo, a.hi / b.lo);
+                }
+                else if (def->op == QuadOp::Shr)
+                {
+                    return Range(a.lo >> b.lo, a.hi >> b.lo);
+                }
+
+                return clamp((__int128)a.lo << b.lo, (__int128)a.hi << b.lo, type);
+            }
+            default:
+                break;
+        }
+
+        return full_range(type);
+    }
+
+public:
+    RangeAnalysis(std::shared_ptr<BasicBlock> block, std::map<Quad *, Loop *>& loop_of) : block(block), loop_of(loop_of) {}
+
+    /**
+     * Gets the range of an operand where it is used by a quad in the block.
+     */
+    Range range(std::shared_ptr<Operand> operand, std::shared_ptr<Quad> use, int depth = 0)
+    {
+        if (operand->type == OperandType::IntConst)
+        {
+            return Range(operand->iconst, operand->iconst);
+        }
+        else if (operand->type != OperandType::Variable)
+        {
+            return Range(LONG_MIN, LONG_MAX);
+        }
+
+        auto symbol = operand->symbol;
+        if (symbol->is_temp && depth < max_depth)
+        {
+            auto def = find_def(symbol, block);
+            if (def != nullptr)
+            {
+                return def_range(def, depth + 1);
+            }
+        }
+
+        // within the body of a counted loop, the induction variable is between its first and last value
+        auto loop = loop_of.find(use.get()) != loop_of.end() ? loop_of[use.get()] : nullptr;
+        auto trip_count = loop != nullptr && symbol == loop->induction ? loop->trip_count() : std::nullopt;
+        if (trip_count)
+        {
+            auto first = loop->start.value();
+            return Range(first, first + std::max(trip_count.value() - 1, 0L) * loop->step);
+        }
+
+        return full_range(symbol->type);
+    }
+
+    /**
+     * Gets the constant c if the operand is the induction variable of the loop plus c, where it is used by a quad in the
+     * body of the loop.
+     */
+    std::optional<long> offset(std::shared_ptr<Operand> operand, Loop& loop, int depth = 0)
+    {
+        if (operand->type != OperandType::Variable)
+        {
+            return {};
+        }
+        else if (operand->symbol == loop.induction)
+        {
+            return 0;
+        }
+        else if (!operand->symbol->is_temp || depth >= max_depth)
+        {
+            return {};
+        }
+
+        auto def = find_def(operand->symbol, block);
+        if (def == nullptr)
+        {
+            return {};
+        }
+
+        switch (def->op)
+        {
+            case QuadOp::Copy:
+                return offset(def->arg1, loop, depth + 1);
+            case QuadOp::Cast:
+            {
+                // only conversions that keep every value of the induction variable
+                auto from = def->arg1->type == OperandType::Variable ? def->arg1->symbol->type : nullptr;
+                auto to = def->res->symbol->type;
+                if (from == nullptr || !from->is_integer() || from->min_value() < to->min_value() || from->max_value() > to->max_value())
+                {
+                    return {};
+                }
+
+                return offset(def->arg1, loop, depth + 1);
+            }
+            case QuadOp::Add:
+            case QuadOp::Sub:
+            {
+                auto c = range(def->arg2, def, depth + 1);
+                auto base = offset(def->arg1, loop, depth + 1);
+                if (!base || c.lo != c.hi || c.lo < INT_MIN || c.lo > INT_MAX)
+                {
+                    return {};
+                }
+
+                return def->op == QuadOp::Add ? base.value() + c.lo : base.value() - c.lo;
+            }
+            default:
+                return {};
+        }
+    }
+};
+
+/**
+ * Checks, before a counted loop runs, the first and last index of each access that is the induction variable plus
+ * a constant, instead of checking the index in every iteration. The loop only runs these checks if it runs at all,
+ * and the induction variable is increased by 1, so every index in between is in bounds too.
+ *     goto before
+ *     label before
+ *     if (!(i < bound)) goto guard
+ *     check i + c < size
+ *     check bound - 1 + c < size
+ *     goto guard
+ * An access that would go out of bounds in a later iteration traps before the first iteration. The additions may
+ * overflow for a bound near the limit of its type, where the access itself would trap first, so they wrap.
+ */
+static void hoist_checks(Loop& loop, std::set<std::pair<long, long>>& accesses, std::shared_ptr<SymbolTable> symbol_table)
+{
+    auto guard_label = loop.preheader->qlist.get_tail()->arg1;
+    auto i = Operand::MakeVariableOperand(loop.induction);
+
+    std::vector<std::shared_ptr<Quad>> quads;
+    quads.push_back(Quad::MakeIfOp(loop.compare == QuadOp::IfLt ? QuadOp::IfGeq : QuadOp::IfGt, i, loop.bound, guard_label));
+
+    auto add = [&](std::shared_ptr<Operand> base, long c)
+    {
+        auto sum = Operand::MakeVariableOperand(symbol_table->new_temp(loop.induction->type));
+        auto quad = Quad::MakeBinOp(QuadOp::Add, base, Operand::MakeIntConstOperand(c), sum);
+        quad->wraps = true;
+        quads.push_back(quad);
+        return sum;
+    };
+
+    for (auto& [c, size] : accesses)
+    {
+        auto size_operand = Operand::MakeIntConstOperand(size);
+        if (!loop.start || loop.start.value() + c < 0 || loop.start.value() + c >= size)
+        {
+            quads.push_back(Quad::MakeCheckOp(c == 0 ? i : add(i, c), size_operand));
+        }
+
+        auto last = loop.compare == QuadOp::IfLt ? c - 1 : c;
+        if (loop.bound->type == OperandType::IntConst)
+        {
+            quads.push_back(Quad::MakeCheckOp(Operand::MakeIntConstOperand(loop.bound->iconst + last), size_operand));
+        }
+        else
+        {
+            quads.push_back(Quad::MakeCheckOp(last == 0 ? loop.bound : add(loop.bound, last), size_operand));
+        }
+    }
+
+    loop.insert_before(quads);
+}
+
+/**
+ * Inserts a check of the index of each access to an array of known size, that traps if the index is out of bounds.
+ * No check is inserted when the range analysis proves that the index is in bounds, and accesses indexed by the
+ * induction variable of a counted loop are checked once before the loop instead of in every iteration.
+ * Returns true if any checks were moved before loops, in which case the CFG must be constructed again.
+ */
+bool InsertBoundsChecks(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table, const std::string& function_name, const Options& options)
+{
+    auto loops = FindLoops(cfg);
+    std::map<Quad *, Loop *> loop_of;
+    for (auto& loop : loops)
+    {
+        if (!loop.is_counted)
+        {
+            continue;
+        }
+
+        for (auto quad = loop.body->qlist.begin(); quad != loop.body->qlist.end(); quad = quad->next)
+        {
+            if (loop.update.find(quad.get()) == loop.update.end())
+            {
+                loop_of[quad.get()] = &loop;
+            }
+        }
+    }
+
+    auto total = 0, proven = 0, hoisted = 0;
+    std::map<Loop *, std::set<std::pair<long, long>>> hoisted_accesses;
+    for (auto& block : cfg)
+    {
+        RangeAnalysis analysis(block, loop_of);
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            // array parameters are pointers, even when they are declared with a size
+            auto array = quad->op == QuadOp::AddPtr ? quad->arg1->symbol : nullptr;
+            if (array == nullptr || array->type->type != TypeType::Array || !array->type->num_elems || array->is_parameter)
+            {
+                continue;
+            }
+
+            total++;
+            auto size = array->type->num_elems.value();
+            if (analysis.range(quad->arg2, quad).within(size))
+            {
+                proven++;
+                continue;
+            }
+
+            auto loop = loop_of.find(quad.get()) != loop_of.end() ? loop_of[quad.get()] : nullptr;
+            auto c = loop != nullptr && loop->step == 1 ? analysis.offset(quad->arg2, *loop) : std::nullopt;
+            if (c)
+            {
+                hoisted_accesses[loop].insert({ c.value(), size });
+                hoisted++;
+                continue;
+            }
+
+            auto check = Quad::MakeCheckOp(quad->arg2, Operand::MakeIntConstOperand(size));
+            block->qlist.insert_after(quad, check);
+            quad = check;
+        }
+    }
+
+    for (auto& [loop, accesses] : hoisted_accesses)
+    {
+        hoist_checks(*loop, accesses, symbol_table);
+    }
+
+    if (total > 0)
+    {
+        options.remark("bounds-check", function_name, std::to_string(proven) + " of " + std::to_string(total) + " bounds checks proven unnecessary, "
+            + std::to_string(hoisted) + " moved before loops, " + std::to_string(total - proven - hoisted) + " checked at the access");
+    }
+
+    return !hoisted_accesses.empty();
+}
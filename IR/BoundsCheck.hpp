@@ -0,0 +1,9 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include "CFG.hpp"
+#include "Options.hpp"
+
+bool InsertBoundsChecks(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table, const std::string& function_name, const Options& options);
@@ -17,6 +17,34 @@ std::vector<std::shared_ptr<BasicBlock>> ConstructCFG(QuadList& qlist)
     return blocks;
 }
 
+/**
+ * Counts the quads in the block.
+ */
+int count_quads(std::shared_ptr<BasicBlock> block)
+{
+    auto count = 0;
+    for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * Counts the quads in the CFG.
+ */
+int count_quads(std::vector<std::shared_ptr<BasicBlock>>& cfg)
+{
+    auto count = 0;
+    for (auto& block : cfg)
+    {
+        count += count_quads(block);
+    }
+
+    return count;
+}
+
 /**
  * Finds the next basic block.
  */
@@ -35,6 +63,7 @@ static std::shared_ptr<BasicBlock> find_next_block(std::shared_ptr<Quad> instruc
             case QuadOp::IfLeq:
             case QuadOp::IfGt:
             case QuadOp::IfGeq:
+            case QuadOp::Switch:
             case QuadOp::Return:
                 return std::make_shared<BasicBlock>(first, curr);
             default:
@@ -110,6 +139,14 @@ static void link_blocks(std::vector<std::shared_ptr<BasicBlock>>& blocks)
                 block_for_label = find_block_for_label(blocks, last->res->strconst);
                 block->link(block_for_label);
                 break;
+            case QuadOp::Switch:
+                for (auto& c : last->cases)
+                {
+                    block->link(find_block_for_label(blocks, c.second->strconst));
+                }
+
+                block->link(find_block_for_label(blocks, last->res->strconst));
+                continue;
             case QuadOp::Return:
                 continue;
             default:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include "Quad.hpp"
 
 struct BBList;
@@ -13,6 +14,12 @@ struct BasicBlock
     QuadList qlist;
     std::vector<BasicBlock *> in;
     std::vector<BasicBlock *> out;
+
+    /* filled in by ComputeLiveness */
+    std::set<Symbol *> live_in;
+    std::set<Symbol *> live_out;
+    std::size_t max_live = 0;
+
     BasicBlock(std::shared_ptr<Quad> first, std::shared_ptr<Quad> last) : qlist(QuadList(first, last)) {}
 
     inline void link(std::shared_ptr<BasicBlock> to)
@@ -22,4 +29,6 @@ struct BasicBlock
     }
 };
 
-std::vector<std::shared_ptr<BasicBlock>> ConstructCFG(QuadList& qlist);
\ No newline at end of file
+std::vector<std::shared_ptr<BasicBlock>> ConstructCFG(QuadList& qlist);
+int count_quads(std::shared_ptr<BasicBlock> block);
+int count_quads(std::vector<std::shared_ptr<BasicBlock>>& cfg);
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include <functional>
+#include <algorithm>
+#include "CallGraph.hpp"
+
+/**
+ * Constructs the call graph from the quads of the functions.
+ */
+CallGraph::CallGraph(std::vector<std::shared_ptr<FunctionDef>>& functions)
+{
+    for (auto& f : functions)
+    {
+        if (!f->is_proto())
+        {
+            definitions[f->function.get()] = f;
+        }
+    }
+
+    for (auto& [function, def] : definitions)
+    {
+        callees[function];
+        callers[function];
+        for (auto quad = def->ir_list.begin(); quad != def->ir_list.end(); quad = quad->next)
+        {
+            if (quad->op == QuadOp::Call)
+            {
+                auto callee = quad->arg1->symbol.get();
+                callees[function].insert(callee);
+                callers[callee].insert(function);
+            }
+        }
+    }
+}
+
+/**
+ * Finds the strongly connected components of the defined functions with Tarjan's algorithm, i.e. the sets of
+ * functions that call each other recursively. The components are in bottom up order: a component comes after
+ * every component it calls into.
+ */
+std::vector<std::vector<Symbol *>> CallGraph::sccs()
+{
+    std::vector<std::vector<Symbol *>> components;
+    std::map<Symbol *, int> index;
+    std::map<Symbol *, int> low;
+    std::vector<Symbol *> stack;
+    std::set<Symbol *> on_stack;
+
+    std::function<void(Symbol *)> visit = [&](Symbol *function)
+    {
+        auto next_index = (int)index.size();
+        index[function] = next_index;
+        low[function] = next_index;
+        stack.push_back(function);
+        on_stack.insert(function);
+
+        for (auto callee : callees[function])
+        {
+            if (!is_defined(callee))
+            {
+                continue;
+            }
+            else if (index.find(callee) == index.end())
+            {
+                visit(callee);
+                low[function] = std::min(low[function], low[callee]);
+            }
+            else if (on_stack.find(callee) != on_stack.end())
+            {
+                low[function] = std::min(low[function], index[callee]);
+            }
+        }
+
+        if (low[function] == index[function])
+        {
+            std::vector<Symbol *> component;
+            Symbol *member;
+            do
+            {
+                member = stack.back();
+                stack.pop_back();
+                on_stack.erase(member);
+                component.push_back(member);
+            } while (member != function);
+
+            components.push_back(component);
+        }
+    };
+
+    for (auto& [function, def] : definitions)
+    {
+        if (index.find(function) == index.end())
+        {
+            visit(function);
+        }
+    }
+
+    return components;
+}
+
+/**
+ * Finds the functions that can be reached by calls from the function, including the function itself.
+ */
+std::set<Symbol *> CallGraph::reachable_from(Symbol *function)
+{
+    std::set<Symbol *> reached = { function };
+    std::vector<Symbol *> work = { function };
+    while (!work.empty())
+    {
+        auto caller = work.back();
+        work.pop_back();
+        for (auto callee : callees[caller])
+        {
+            if (reached.insert(callee).second)
+            {
+                work.push_back(callee);
+            }
+        }
+    }
+
+    return reached;
+}
+
+/**
+ * Checks if the symbol is a global variable, as opposed to a local variable or a function.
+ */
+bool IsGlobalVariable(std::shared_ptr<Symbol> symbol)
+{
+    return symbol->scope == GLOBAL_SCOPE && symbol->type->type != TypeType::Function;
+}
+
+/**
+ * Adds the globals the quad modifies and references to mod_ref.
+ */
+static void add_accesses(std::shared_ptr<Quad> quad, ModRef& mod_ref)
+{
+    for (auto& operand : quad->uses())
+    {
+        if (IsGlobalVariable(operand->symbol))
+        {
+            mod_ref.ref.insert(operand->symbol.get());
+            if (operand->symbol->type->type == TypeType::Array || quad->op == QuadOp::AddrOf)
+            {
+                // the elements are written through the address, which is not tracked
+                mod_ref.mod.insert(operand->symbol.get());
+            }
+        }
+    }
+
+    auto def = quad->def();
+    if (def != nullptr && IsGlobalVariable(def->symbol))
+    {
+        mod_ref.mod.insert(def->symbol.get());
+    }
+}
+
+/**
+ * Computes the globals each function may modify and reference. A function's set includes the sets of the functions
+ * it calls, found by propagating them up the call graph until nothing changes, so recursion is handled. Functions
+ * without a definition may touch every global, unless the whole program is visible, in which case the globals are
+ * internal and the external code cannot name them.
+ */
+std::map<Symbol *, ModRef> ComputeModRef(CallGraph& graph, bool whole_program)
+{
+    std::map<Symbol *, ModRef> mod_refs;
+    for (auto& [function, def] : graph.definitions)
+    {
+        auto& mod_ref = mod_refs[function];
+        for (auto quad = def->ir_list.begin(); quad != def->ir_list.end(); quad = quad->next)
+        {
+            add_accesses(quad, mod_ref);
+        }
+
+        for (auto callee : graph.callees[function])
+        {
+            if (!graph.is_defined(callee))
+            {
+                mod_refs[callee].all = !whole_program;
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto& [function, mod_ref] : mod_refs)
+        {
+            for (auto callee : graph.callees[function])
+            {
+                auto& callee_mod_ref = mod_refs[callee];
+                auto mod_size = mod_ref.mod.size();
+                auto ref_size = mod_ref.ref.size();
+                auto all = mod_ref.all;
+
+                mod_ref.mod.insert(callee_mod_ref.mod.begin(), callee_mod_ref.mod.end());
+                mod_ref.ref.insert(callee_mod_ref.ref.begin(), callee_mod_ref.ref.end());
+                mod_ref.all = mod_ref.all || callee_mod_ref.all;
+                changed = changed || mod_size != mod_ref.mod.size() || ref_size != mod_ref.ref.size() || all != mod_ref.all;
+            }
+        }
+    }
+
+    return mod_refs;
+}
+
+/**
+ * Finds the calls to each function. An argument is constant if it is an int constant, or a temp that was set to one
+ * earlier in the same block.
+ */
+std::map<Symbol *, std::vector<CallSite>> FindCallSites(std::vector<std::shared_ptr<FunctionDef>>& functions)
+{
+    std::map<Symbol *, std::vector<CallSite>> call_sites;
+    for (auto& def : functions)
+    {
+        std::vector<std::pair<std::shared_ptr<Quad>, std::optional<long>>> param_stack;
+        std::map<Symbol *, long> constants;
+        for (auto quad = def->ir_list.begin(); quad != def->ir_list.end(); quad = quad->next)
+        {
+            if (quad->op == QuadOp::Label)
+            {
+                constants.clear();
+            }
+            else if (quad->op == QuadOp::Param)
+            {
+                std::optional<long> constant;
+                if (quad->arg1->type == OperandType::IntConst)
+                {
+                    constant = quad->arg1->iconst;
+                }
+                else if (quad->arg1->type == OperandType::Variable && constants.find(quad->arg1->symbol.get()) != constants.end())
+                {
+                    constant = constants[quad->arg1->symbol.get()];
+                }
+
+                param_stack.push_back({ quad, constant });
+            }
+            else if (quad->op == QuadOp::Call)
+            {
+                CallSite site = { def, quad };
+                auto first = param_stack.end() - quad->arg2->iconst;
+                for (auto it = first; it != param_stack.end(); it++)
+                {
+                    site.params.push_back(it->first);
+                    site.constants.push_back(it->second);
+                }
+
+                param_stack.erase(first, param_stack.end());
+                call_sites[quad->arg1->symbol.get()].push_back(site);
+            }
+
+            auto def_operand = quad->def();
+            if (def_operand != nullptr && def_operand->symbol->is_temp && quad->op == QuadOp::Copy && quad->arg1->type == OperandType::IntConst)
+            {
+                constants[def_operand->symbol.get()] = quad->arg1->iconst;
+            }
+            else if (def_operand != nullptr)
+            {
+                constants.erase(def_operand->symbol.get());
+            }
+        }
+    }
+
+    return call_sites;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <memory>
+#include <vector>
+#include <optional>
+#include "SyntaxTree.hpp"
+
+/**
+ * Represents the calls between the functions of a program. Functions that are only declared, e.g. extern functions,
+ * have no definition and may do anything.
+ */
+struct CallGraph
+{
+    std::map<Symbol *, std::shared_ptr<FunctionDef>> definitions;
+    std::map<Symbol *, std::set<Symbol *>> callees;
+    std::map<Symbol *, std::set<Symbol *>> callers;
+
+    CallGraph(std::vector<std::shared_ptr<FunctionDef>>& functions);
+
+    inline bool is_defined(Symbol *function) { return definitions.find(function) != definitions.end(); }
+    std::vector<std::vector<Symbol *>> sccs();
+    std::set<Symbol *> reachable_from(Symbol *function);
+};
+
+/**
+ * Represents a call to a function, with the param quads that pass its arguments and the values of the arguments
+ * that are constants.
+ */
+struct CallSite
+{
+    std::shared_ptr<FunctionDef> caller;
+    std::shared_ptr<Quad> call;
+    std::vector<std::shared_ptr<Quad>> params;
+    std::vector<std::optional<long>> constants;
+};
+
+/**
+ * The globals a function may modify or reference, including through the functions it calls.
+ */
+struct ModRef
+{
+    std::set<Symbol *> mod;
+    std::set<Symbol *> ref;
+    bool all = false;   // the function may modify and reference every global
+
+    inline bool may_mod(Symbol *global) { return all || mod.find(global) != mod.end(); }
+    inline bool may_ref(Symbol *global) { return all || ref.find(global) != ref.end(); }
+};
+
+bool IsGlobalVariable(std::shared_ptr<Symbol> symbol);
+std::map<Symbol *, ModRef> ComputeModRef(CallGraph& graph, bool whole_program);
+std::map<Symbol *, std::vector<CallSite>> FindCallSites(std::vector<std::shared_ptr<FunctionDef>>& functions);
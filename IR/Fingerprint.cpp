@@ -0,0 +1,149 @@
+#include <sstream>
+#include "CallGraph.hpp"
+#include "Fingerprint.hpp"
+
+/**
+ * Writes the type, including the types it is made of.
+ */
+static void write_type(std::ostream& out, std::shared_ptr<Type> type)
+{
+    if (type == nullptr)
+    {
+        out << "_";
+        return;
+    }
+
+    out << "(" << (int)type->type << (type->is_unsigned ? "u" : "") << (type->is_restrict ? "r" : "");
+    if (type->num_elems)
+    {
+        out << "[" << type->num_elems.value() << "]";
+    }
+
+    if (type->elem_type != nullptr)
+    {
+        write_type(out, type->elem_type);
+    }
+
+    if (type->type == TypeType::Function)
+    {
+        write_type(out, type->ret_type);
+        for (auto& param_type : type->param_types)
+        {
+            write_type(out, param_type);
+        }
+    }
+
+    out << ")";
+}
+
+/**
+ * Writes the symbol with its type and what kind of variable it is.
+ */
+static void write_symbol(std::ostream& out, std::shared_ptr<Symbol> symbol)
+{
+    out << symbol->get_name() << (symbol->is_parameter ? "p" : "") << (symbol->is_temp ? "t" : "");
+    write_type(out, symbol->type);
+}
+
+/**
+ * Writes the operand. Labels are numbered in the order they appear in the function rather than written by name,
+ * since the names come from a counter shared by every function.
+ */
+static void write_operand(std::ostream& out, std::shared_ptr<Operand> operand, std::map<std::string, int>& labels)
+{
+    if (operand == nullptr)
+    {
+        out << "_ ";
+        return;
+    }
+
+    switch (operand->type)
+    {
+        case OperandType::IntConst:
+            out << "i" << operand->iconst;
+            break;
+        case OperandType::FloatConst:
+            out << "f" << std::hexfloat << operand->fconst << std::defaultfloat;
+            break;
+        case OperandType::StrConst:
+            out << "s" << operand->strconst.size() << ":" << operand->strconst;
+            break;
+        case OperandType::Label:
+            out << "L" << labels.emplace(operand->strconst, labels.size()).first->second;
+            break;
+        case OperandType::Variable:
+            write_symbol(out, operand->symbol);
+            break;
+    }
+
+    out << " ";
+}
+
+/**
+ * Writes everything the optimizer and code generator read from the function: its signature, its variables, its
+ * quads, and for each function it calls, the callee's signature and whether the program defines it.
+ */
+static std::string fingerprint(std::shared_ptr<FunctionDef> def, CallGraph& graph)
+{
+    std::ostringstream out;
+    write_symbol(out, def->function);
+    for (auto& param : def->params)
+    {
+        write_symbol(out, param);
+    }
+
+    out << "\nvariables";
+    for (auto& variable : def->symbol_table->get_all_variables())
+    {
+        out << " ";
+        write_symbol(out, variable);
+    }
+
+    out << "\n";
+    std::map<std::string, int> labels;
+    for (auto quad = def->ir_list.begin(); quad != def->ir_list.end(); quad = quad->next)
+    {
+        out << (int)quad->op << " ";
+        write_operand(out, quad->arg1, labels);
+        write_operand(out, quad->arg2, labels);
+        write_operand(out, quad->res, labels);
+        for (auto& [value, label] : quad->cases)
+        {
+            out << value << ":";
+            write_operand(out, label, labels);
+        }
+
+        if (quad->unroll)
+        {
+            out << "unroll " << quad->unroll.value();
+        }
+
+        out << (quad->wraps ? "wraps" : "") << "\n";
+        if (quad->op == QuadOp::Call)
+        {
+            out << (graph.is_defined(quad->arg1->symbol.get()) ? "defined\n" : "undefined\n");
+        }
+    }
+
+    return out.str();
+}
+
+/**
+ * Gets a fingerprint of each defined function, which is the same for two compilations only if the function's
+ * optimized quads and LLVM code would be the same, apart from the attributes inferred from the rest of the program.
+ * It is taken after the interprocedural passes, so it covers what they brought into the function from others.
+ */
+std::map<FunctionDef *, std::string> FingerprintFunctions(std::vector<std::shared_ptr<FunctionDef>>& functions)
+{
+    CallGraph graph(functions);
+    std::map<FunctionDef *, std::string> fingerprints;
+    for (auto& f : functions)
+    {
+        if (!f->is_proto())
+        {
+            fingerprints[f.get()] = fingerprint(f, graph);
+        }
+    }
+
+    return fingerprints;
+}
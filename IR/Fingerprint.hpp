@@ -0,0 +1,9 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SyntaxTree.hpp"
+
+std::map<FunctionDef *, std::string> FingerprintFunctions(std::vector<std::shared_ptr<FunctionDef>>& functions);
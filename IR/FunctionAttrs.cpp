@@ -0,0 +1,202 @@
+#include <map>
+#include <algorithm>
+#include "CallGraph.hpp"
+#include "FunctionAttrs.hpp"
+
+/**
+ * Checks if the symbol is an array that is local to the function, whose memory the caller can not see.
+ */
+static bool is_local_array(std::shared_ptr<Symbol> symbol)
+{
+    return symbol->type->type == TypeType::Array && symbol->scope != GLOBAL_SCOPE && !symbol->is_parameter;
+}
+
+/**
+ * Finds the effects of the function's own quads. Accesses through pointers into the function's local arrays
+ * are not effects, since the caller can not see them.
+ */
+Effects FindDirectEffects(std::shared_ptr<FunctionDef> def, CallGraph& graph)
+{
+    Effects effects;
+    std::set<Symbol *> local_pointers;
+    std::map<std::string, bool> seen_labels;
+    for (auto quad = def->ir_list.begin(); quad != def->ir_list.end(); quad = quad->next)
+    {
+        auto is_local = [&](std::shared_ptr<Operand> operand) { return local_pointers.find(operand->symbol.get()) != local_pointers.end(); };
+        switch (quad->op)
+        {
+            case QuadOp::AddPtr:
+                if (is_local_array(quad->arg1->symbol) || is_local(quad->arg1))
+                {
+                    local_pointers.insert(quad->res->symbol.get());
+                }
+                break;
+            case QuadOp::RDeref:
+                effects.reads = effects.reads || !is_local(quad->arg1);
+                break;
+            case QuadOp::LDeref:
+                effects.writes = effects.writes || !is_local(quad->res);
+                break;
+            case QuadOp::AddrOf:
+                effects.reads = effects.reads || IsGlobalVariable(quad->arg1->symbol);
+                effects.writes = effects.writes || IsGlobalVariable(quad->arg1->symbol);
+                break;
+            case QuadOp::Check:
+                effects.may_not_return = true;
+                break;
+            case QuadOp::Label:
+                seen_labels[quad->arg1->strconst] = true;
+                break;
+            case QuadOp::Goto:
+            case QuadOp::IfEq:
+            case QuadOp::IfNeq:
+            case QuadOp::IfLt:
+            case QuadOp::IfLeq:
+            case QuadOp::IfGt:
+            case QuadOp::IfGeq:
+            {
+                // a jump back to a label that was already seen may be a loop that does not end
+                auto label = quad->op == QuadOp::Goto ? quad->arg1 : quad->res;
+                effects.may_not_return = effects.may_not_return || seen_labels[label->strconst];
+                break;
+            }
+            case QuadOp::Switch:
+                effects.may_not_return = effects.may_not_return || seen_labels[quad->res->strconst];
+                for (auto& [value, label] : quad->cases)
+                {
+                    effects.may_not_return = effects.may_not_return || seen_labels[label->strconst];
+                }
+                break;
+            case QuadOp::Call:
+                effects.calls_unknown = effects.calls_unknown || !graph.is_defined(quad->arg1->symbol.get());
+                break;
+            default:
+                break;
+        }
+
+        for (auto& operand : quad->uses())
+        {
+            effects.reads = effects.reads || (quad->op != QuadOp::Call && IsGlobalVariable(operand->symbol));
+        }
+
+        auto def_operand = quad->def();
+        effects.writes = effects.writes || (def_operand != nullptr && IsGlobalVariable(def_operand->symbol));
+    }
+
+    return effects;
+}
+
+/**
+ * Checks if the type is passed to a function as a pointer.
+ */
+static bool is_pointer(std::shared_ptr<Type> type)
+{
+    return type->type == TypeType::Pointer || (type->type == TypeType::Array && !type->num_elems);
+}
+
+/**
+ * Checks if the argument is an array of its own, i.e. a local or global array, rather than a pointer that may point
+ * anywhere.
+ */
+static bool is_array_object(std::shared_ptr<Operand> arg)
+{
+    return arg->type == OperandType::Variable && arg->symbol->type->type == TypeType::Array && !arg->symbol->is_parameter;
+}
+
+/**
+ * Finds the pointer parameters of the function that can be noalias. Every call must pass an array object that no other
+ * argument of the call may point into, and that the function does not access as a global. The function must also not
+ * read a global pointer, which could point into one of the arrays.
+ */
+static std::set<int> find_noalias_params(std::shared_ptr<FunctionDef> def, std::vector<CallSite>& sites, ModRef& mod_ref)
+{
+    std::set<int> noalias;
+    if (sites.empty() || mod_ref.all || std::any_of(mod_ref.ref.begin(), mod_ref.ref.end(), [](Symbol *g) { return g->type->type == TypeType::Pointer; }))
+    {
+        return noalias;
+    }
+
+    for (auto i = 0; i < def->params.size(); i++)
+    {
+        auto distinct = is_pointer(def->params[i]->type);
+        for (auto& site : sites)
+        {
+            auto arg = site.params[i]->arg1;
+            distinct = distinct && is_array_object(arg) && !mod_ref.may_ref(arg->symbol.get()) && !mod_ref.may_mod(arg->symbol.get());
+            for (auto j = 0; j < site.params.size() && distinct; j++)
+            {
+                auto other = site.params[j]->arg1;
+                auto other_is_pointer = other->type == OperandType::Variable && (other->symbol->type->type == TypeType::Array || other->symbol->type->type == TypeType::Pointer);
+                distinct = j == i || !other_is_pointer || (is_array_object(other) && other->symbol != arg->symbol);
+            }
+        }
+
+        if (distinct)
+        {
+            noalias.insert(i);
+        }
+    }
+
+    return noalias;
+}
+
+/**
+ * Infers the attributes of the defined functions from their quads and the call graph. The functions are visited
+ * bottom up, so the effects of a function's callees are known before it. The functions in a recursive component
+ * share their effects. Every function is nounwind, since C has no exceptions. A function that was loaded from the
+ * compile cache has its effects from the cache, since its quads were not optimized.
+ */
+void InferFunctionAttributes(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options)
+{
+    CallGraph graph(functions);
+    auto mod_refs = ComputeModRef(graph, options.whole_program);
+    auto call_sites = FindCallSites(functions);
+
+    std::map<Symbol *, Effects> effects;
+    for (auto& scc : graph.sccs())
+    {
+        Effects combined;
+        std::set<Symbol *> members(scc.begin(), scc.end());
+        auto recursive = scc.size() > 1 || graph.callees[scc.front()].count(scc.front()) > 0;
+        for (auto function : scc)
+        {
+            auto def = graph.definitions[function];
+            combined.merge(def->cached_effects ? def->cached_effects.value() : FindDirectEffects(def, graph));
+            for (auto callee : graph.callees[function])
+            {
+                if (graph.is_defined(callee) && members.find(callee) == members.end())
+                {
+                    combined.merge(effects[callee]);
+                }
+            }
+        }
+
+        for (auto function : scc)
+        {
+            effects[function] = combined;
+
+            auto def = graph.definitions[function];
+            auto& attributes = def->attributes;
+            attributes.internal = attributes.internal || (options.whole_program && function->get_name() != "main");
+            attributes.readnone = !combined.calls_unknown && !combined.reads && !combined.writes;
+            attributes.readonly = !attributes.readnone && !combined.calls_unknown && !combined.writes;
+            attributes.nounwind = true;
+            attributes.norecurse = !recursive && (!combined.calls_unknown || options.whole_program);
+            attributes.willreturn = !recursive && !combined.calls_unknown && !combined.may_not_return;
+            if (attributes.internal)
+            {
+                // every call is known, so the arguments passed for each parameter are too
+                attributes.noalias = find_noalias_params(def, call_sites[function], mod_refs[function]);
+            }
+        }
+    }
+
+    // prototypes are given the attributes of their definitions, since either may create the LLVM function
+    for (auto& f : functions)
+    {
+        if (f->is_proto() && graph.is_defined(f->function.get()))
+        {
+            f->attributes = graph.definitions[f->function.get()]->attributes;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <set>
+#include <memory>
+#include <vector>
+#include "Options.hpp"
+
+struct FunctionDef;
+struct CallGraph;
+
+/**
+ * The effects of a function on memory and control, either of its own quads or including the functions it calls.
+ */
+struct Effects
+{
+    bool reads = false;
+    bool writes = false;
+    bool calls_unknown = false; // calls a function without a definition
+    bool may_not_return = false; // has a loop or a check that may trap
+
+    inline void merge(const Effects& other)
+    {
+        reads = reads || other.reads;
+        writes = writes || other.writes;
+        calls_unknown = calls_unknown || other.calls_unknown;
+        may_not_return = may_not_return || other.may_not_return;
+    }
+};
+
+/**
+ * What is known about a function from its quads and the functions it calls, given to LLVM as attributes.
+ */
+struct FunctionAttributes
+{
+    bool internal = false;      // only called from within the program
+    bool readnone = false;      // does not access memory that is visible to the caller
+    bool readonly = false;      // only reads memory that is visible to the caller
+    bool nounwind = false;
+    bool norecurse = false;
+    bool willreturn = false;
+    std::set<int> noalias;      // the pointer parameters that no other pointer in the function may access the memory of
+};
+
+Effects FindDirectEffects(std::shared_ptr<FunctionDef> def, CallGraph& graph);
+void InferFunctionAttributes(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options);
@@ -3,6 +3,9 @@
 #include "Error.hpp"
 #include "Quad.hpp"
 
+// the labels that a break statement jumps to, innermost last
+static std::vector<std::shared_ptr<Operand>> break_labels;
+
 /**
  * Generates IR for the AST node.
  */
@@ -90,10 +93,14 @@ void WhileLoop::ir_codegen()
     auto end_label = Operand::MakeLabelOperand();
 
     guard->ir_codegen_bool(top_label, end_label);
+    break_labels.push_back(end_label);
     body->ir_codegen();
+    break_labels.pop_back();
 
     ir_list = QuadList::append(ir_list, Quad::MakeGotoOp(eval_label));
-    ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(top_label));
+    auto top = Quad::MakeLabelOp(top_label);
+    top->unroll = unroll;
+    ir_list = QuadList::append(ir_list, top);
     ir_list = QuadList::concat(ir_list, body->ir_list);
     ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(eval_label));
     ir_list = QuadList::concat(ir_list, guard->ir_list);
@@ -122,6 +129,12 @@ void ForLoop::ir_codegen()
         guard->ir_codegen_bool(top_label, end_label);
         guard_list = guard->ir_list;
     }
+    else
+    {
+        // a missing guard loops forever
+        auto goto_inst = Quad::MakeGotoOp(top_label);
+        guard_list = QuadList(goto_inst, goto_inst);
+    }
 
     QuadList update_list;
     if (update != nullptr)
@@ -130,11 +143,15 @@ void ForLoop::ir_codegen()
         update_list = update->ir_list;
     }
     
+    break_labels.push_back(end_label);
     body->ir_codegen();
+    break_labels.pop_back();
 
     ir_list = QuadList::concat(ir_list, init_list);
     ir_list = QuadList::append(ir_list, Quad::MakeGotoOp(eval_label));
-    ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(top_label));
+    auto top = Quad::MakeLabelOp(top_label);
+    top->unroll = unroll;
+    ir_list = QuadList::append(ir_list, top);
     ir_list = QuadList::concat(ir_list, body->ir_list);
     ir_list = QuadList::concat(ir_list, update_list);
     ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(eval_label));
@@ -142,6 +159,59 @@ void ForLoop::ir_codegen()
     ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(end_label));
 }
 
+/**
+ * Generates IR for the AST node.
+ */
+void SwitchStatement::ir_codegen()
+{
+    auto end_label = Operand::MakeLabelOperand();
+    auto default_label = end_label;
+
+    std::vector<std::shared_ptr<Operand>> case_labels;
+    std::vector<std::pair<long, std::shared_ptr<Operand>>> switch_cases;
+    for (auto& c : cases)
+    {
+        auto label = Operand::MakeLabelOperand();
+        case_labels.push_back(label);
+        if (c.value)
+        {
+            switch_cases.push_back(std::make_pair(c.value.value(), label));
+        }
+        else
+        {
+            default_label = label;
+        }
+    }
+
+    guard->ir_codegen();
+    ir_list = QuadList::append(guard->ir_list, Quad::MakeSwitchOp(guard->place, switch_cases, default_label));
+
+    // the cases are laid out in order, so a case without a break falls through to the next one
+    break_labels.push_back(end_label);
+    for (auto i = 0; i < cases.size(); i++)
+    {
+        ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(case_labels[i]));
+        for (auto& statement : cases[i].statements)
+        {
+            statement->ir_codegen();
+            ir_list = QuadList::concat(ir_list, statement->ir_list);
+        }
+    }
+
+    break_labels.pop_back();
+    ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(end_label));
+}
+
+/**
+ * Generates IR for the AST node.
+ */
+void Break::ir_codegen()
+{
+    assert(!break_labels.empty());
+    auto inst = Quad::MakeGotoOp(break_labels.back());
+    ir_list = QuadList(inst, inst);
+}
+
 /**
  * Generates IR for the AST node.
  */
@@ -199,15 +269,56 @@ void BinaryOperation::ir_codegen()
         place = rhs->place;
     };
 
-     auto codegen_compound_binop = [=](QuadOp quad_op)
+    auto codegen_logical = [=](QuadOp quad_op)
+    {
+        if (rhs->is_speculatable())
+        {
+            // the rhs is safe to evaluate even when the lhs decides the result, so no branches are needed
+            codegen_basic_binop(quad_op);
+            return;
+        }
+
+        // otherwise short circuit: v = 0; if (lhs op rhs) v = 1
+        auto true_label = Operand::MakeLabelOperand();
+        auto end_label = Operand::MakeLabelOperand();
+        place = Operand::MakeVariableOperand(symbol_table->new_variable(type));
+        auto init_inst = Quad::MakeUnOp(QuadOp::Copy, Operand::MakeIntConstOperand(0), place);
+
+        ir_codegen_bool(true_label, end_label);
+        auto bool_list = ir_list;
+        ir_list = QuadList(init_inst, init_inst);
+        ir_list = QuadList::concat(ir_list, bool_list);
+        ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(true_label));
+        ir_list = QuadList::append(ir_list, Quad::MakeUnOp(QuadOp::Copy, Operand::MakeIntConstOperand(1), place));
+        ir_list = QuadList::append(ir_list, Quad::MakeLabelOp(end_label));
+    };
+
+    auto codegen_compound_binop = [=](QuadOp quad_op)
     {
-        place = Operand::MakeVariableOperand(symbol_table->new_temp(type));
         bool is_deref = lhs->ir_codegen_lval();
         lhs->ir_codegen();
         rhs->ir_codegen();
         ir_list = QuadList::concat(lhs->ir_list_lval, lhs->ir_list);
         ir_list = QuadList::concat(ir_list, rhs->ir_list);
-        ir_list = QuadList::append(ir_list, Quad::MakeBinOp(quad_op, lhs->place, rhs->place, place));
+
+        // the operation is computed in its own type, and the result is converted back to the type of the lhs
+        auto is_converted = *op_type != *type;
+        auto lhs_place = lhs->place;
+        if (is_converted)
+        {
+            lhs_place = Operand::MakeVariableOperand(symbol_table->new_temp(op_type));
+            ir_list = QuadList::append(ir_list, Quad::MakeUnOp(QuadOp::Cast, lhs->place, lhs_place));
+        }
+
+        place = Operand::MakeVariableOperand(symbol_table->new_temp(op_type));
+        ir_list = QuadList::append(ir_list, Quad::MakeBinOp(quad_op, lhs_place, rhs->place, place));
+        if (is_converted)
+        {
+            auto res = Operand::MakeVariableOperand(symbol_table->new_temp(type));
+            ir_list = QuadList::append(ir_list, Quad::MakeUnOp(QuadOp::Cast, place, res));
+            place = res;
+        }
+
         if (is_deref)
         {
             ir_list = QuadList::append(ir_list, Quad::MakeLDerefOp(place, lhs->location));
@@ -218,41 +329,97 @@ void BinaryOperation::ir_codegen()
         }
     };
 
+    // arithmetic on floating point values has its own quads, comparisons are the same quads for every type
+    bool is_floating = (op_type != nullptr ? op_type : type)->is_floating();
     switch (op)
     {
         case BinOp::Plus:
-            codegen_basic_binop(QuadOp::Add);
+            codegen_basic_binop(is_floating ? QuadOp::FAdd : QuadOp::Add);
             break;
         case BinOp::Minus:
-            codegen_basic_binop(QuadOp::Sub);
+            codegen_basic_binop(is_floating ? QuadOp::FSub : QuadOp::Sub);
             break;
         case BinOp::Times:
-            codegen_basic_binop(QuadOp::Mul);
+            codegen_basic_binop(is_floating ? QuadOp::FMul : QuadOp::Mul);
             break;
         case BinOp::Divide:
-            codegen_basic_binop(QuadOp::Div);
+            codegen_basic_binop(is_floating ? QuadOp::FDiv : QuadOp::Div);
             break;
         case BinOp::Modulo:
             codegen_basic_binop(QuadOp::Mod);
             break;
+        case BinOp::Equal:
+            codegen_basic_binop(QuadOp::Eq);
+            break;
+        case BinOp::NotEqual:
+            codegen_basic_binop(QuadOp::Neq);
+            break;
+        case BinOp::LessThan:
+            codegen_basic_binop(QuadOp::Lt);
+            break;
+        case BinOp::LessThanEqual:
+            codegen_basic_binop(QuadOp::Leq);
+            break;
+        case BinOp::GreaterThan:
+            codegen_basic_binop(QuadOp::Gt);
+            break;
+        case BinOp::GreaterThanEqual:
+            codegen_basic_binop(QuadOp::Geq);
+            break;
+        case BinOp::BitAnd:
+            codegen_basic_binop(QuadOp::BitAnd);
+            break;
+        case BinOp::BitOr:
+            codegen_basic_binop(QuadOp::BitOr);
+            break;
+        case BinOp::BitXor:
+            codegen_basic_binop(QuadOp::BitXor);
+            break;
+        case BinOp::ShiftLeft:
+            codegen_basic_binop(QuadOp::Shl);
+            break;
+        case BinOp::ShiftRight:
+            codegen_basic_binop(QuadOp::Shr);
+            break;
+        case BinOp::And:
+            codegen_logical(QuadOp::And);
+            break;
+        case BinOp::Or:
+            codegen_logical(QuadOp::Or);
+            break;
         case BinOp::Assign:
             codegen_assign();
             break;
         case BinOp::PlusAssign:
-            codegen_compound_binop(QuadOp::Add);
+            codegen_compound_binop(is_floating ? QuadOp::FAdd : QuadOp::Add);
             break;
         case BinOp::MinusAssign:
-            codegen_compound_binop(QuadOp::Sub);
+            codegen_compound_binop(is_floating ? QuadOp::FSub : QuadOp::Sub);
             break;
         case BinOp::TimesAssign:
-            codegen_compound_binop(QuadOp::Mul);
+            codegen_compound_binop(is_floating ? QuadOp::FMul : QuadOp::Mul);
             break;
         case BinOp::DivideAssign:
-            codegen_compound_binop(QuadOp::Div);
+            codegen_compound_binop(is_floating ? QuadOp::FDiv : QuadOp::Div);
             break;
         case BinOp::ModuloAssign:
             codegen_compound_binop(QuadOp::Mod);
             break;
+        case BinOp::BitAndAssign:
+            codegen_compound_binop(QuadOp::BitAnd);
+            break;
+        case BinOp::BitOrAssign:
+            codegen_compound_binop(QuadOp::BitOr);
+            break;
+        case BinOp::BitXorAssign:
+            codegen_compound_binop(QuadOp::BitXor);
+            break;
+        case BinOp::ShiftLeftAssign:
+            codegen_compound_binop(QuadOp::Shl);
+            break;
+        case BinOp::ShiftRightAssign:
+            codegen_compound_binop(QuadOp::Shr);
+            break;
         default:
             assert(false && "unimplemented");
     }
@@ -269,12 +436,22 @@ void UnaryOperation::ir_codegen()
     {
         case UnOp::Negation:
         {
-            auto inst = Quad::MakeUnOp(QuadOp::Neg, expr->place, place);
+            auto inst = Quad::MakeUnOp(type->is_floating() ? QuadOp::FNeg : QuadOp::Neg, expr->place, place);
             ir_list = QuadList::append(expr->ir_list, inst);
             break;
         }
         case UnOp::Not:
-            assert(false && "should be processed in codegen_bool");
+        {
+            auto inst = Quad::MakeUnOp(QuadOp::Not, expr->place, place);
+            ir_list = QuadList::append(expr->ir_list, inst);
+            break;
+        }
+        case UnOp::BitNot:
+        {
+            auto inst = Quad::MakeUnOp(QuadOp::BitNot, expr->place, place);
+            ir_list = QuadList::append(expr->ir_list, inst);
+            break;
+        }
         case UnOp::Deref:
         case UnOp::AddrOf:
             assert(false && "unimplemented");
@@ -284,7 +461,9 @@ void UnaryOperation::ir_codegen()
             place = Operand::MakeVariableOperand(symbol_table->new_temp(type));
             expr->ir_codegen_lval();
             expr->ir_codegen();
-            auto inc_inst = Quad::MakeBinOp(QuadOp::Add, expr->place, Operand::MakeIntConstOperand(op == UnOp::PlusPlus ? 1 : -1), expr->location);
+            auto inc_inst = type->is_floating() ?
+                Quad::MakeBinOp(QuadOp::FAdd, expr->place, Operand::MakeFloatConstOperand(op == UnOp::PlusPlus ? 1.0 : -1.0), expr->location) :
+                Quad::MakeBinOp(QuadOp::Add, expr->place, Operand::MakeIntConstOperand(op == UnOp::PlusPlus ? 1 : -1), expr->location);
             auto copy_inst = Quad::MakeUnOp(QuadOp::Copy, expr->place, place);
             ir_list = QuadList::concat(ir_list, expr->ir_list_lval);
             ir_list = QuadList::concat(ir_list, expr->ir_list);
@@ -315,6 +494,25 @@ void ArrayIndex::ir_codegen()
     ir_list = QuadList::append(ir_list, deref_inst);
 }
 
+/**
+ * Generates IR for the AST node.
+ */
+void TypeCast::ir_codegen()
+{
+    expr->ir_codegen();
+    ir_list = expr->ir_list;
+    if (!type->is_arithmetic() || *expr->type == *type)
+    {
+        // an array decays to a pointer without any code
+        place = expr->place;
+        return;
+    }
+
+    place = Operand::MakeVariableOperand(symbol_table->new_temp(type));
+    auto inst = Quad::MakeUnOp(QuadOp::Cast, expr->place, place);
+    ir_list = QuadList::append(ir_list, inst);
+}
+
 /**
  * Generates IR for the AST node.
  */
@@ -325,6 +523,16 @@ void IntegerConstant::ir_codegen()
     ir_list = QuadList(inst, inst);
 }
 
+/**
+ * Generates IR for the AST node.
+ */
+void FloatConstant::ir_codegen()
+{
+    place = Operand::MakeVariableOperand(symbol_table->new_temp(type));
+    auto inst = Quad::MakeUnOp(QuadOp::Copy, Operand::MakeFloatConstOperand(value), place);
+    ir_list = QuadList(inst, inst);
+}
+
 /**
  * Generates IR for the AST node.
  */
@@ -413,6 +621,53 @@ bool ArrayIndex::ir_codegen_lval()
     return true;
 }
 
+/**
+ * Determines if the expression can be evaluated even when the program would not evaluate it, 
+ * i.e. it has no side effects and cannot trap.
+ */
+bool BinaryOperation::is_speculatable()
+{
+    switch (op)
+    {
+        case BinOp::Plus:
+        case BinOp::Minus:
+        case BinOp::Times:
+        case BinOp::Equal:
+        case BinOp::NotEqual:
+        case BinOp::LessThan:
+        case BinOp::LessThanEqual:
+        case BinOp::GreaterThan:
+        case BinOp::GreaterThanEqual:
+        case BinOp::BitAnd:
+        case BinOp::BitOr:
+        case BinOp::BitXor:
+        case BinOp::ShiftLeft:
+        case BinOp::ShiftRight:
+        case BinOp::And:
+        case BinOp::Or:
+            return lhs->is_speculatable() && rhs->is_speculatable();
+        default:
+            return false; // division can trap, and assignments have side effects
+    }
+}
+
+/**
+ * Determines if the expression can be evaluated even when the program would not evaluate it, 
+ * i.e. it has no side effects and cannot trap.
+ */
+bool UnaryOperation::is_speculatable()
+{
+    switch (op)
+    {
+        case UnOp::Negation:
+        case UnOp::Not:
+        case UnOp::BitNot:
+            return expr->is_speculatable();
+        default:
+            return false;
+    }
+}
+
 /**
  * Creates the jump instructions for the if statement.
  */
@@ -0,0 +1,73 @@
+#include <llvm/Support/TimeProfiler.h>
+#include "SyntaxTree.hpp"
+#include "Liveness.hpp"
+#include "StrengthReduce.hpp"
+#include "BoundsCheck.hpp"
+#include "Vectorize.hpp"
+#include "Unroll.hpp"
+#include "PromoteGlobals.hpp"
+#include "Interprocedural.hpp"
+
+/**
+ * Runs the pass as an event in the -ftime-trace trace, with the function it runs on as the detail, and returns what
+ * the pass returns.
+ */
+template <typename Pass>
+static auto trace(const std::string& name, const std::string& detail, Pass pass)
+{
+    llvm::TimeTraceScope scope(name, detail);
+    return pass();
+}
+
+/**
+ * Optimizes the IR for the function.
+ */
+void FunctionDef::ir_optimize(const Options& options)
+{
+    if (is_proto())
+    {
+        return;
+    }
+
+    auto name = function->get_name();
+    llvm::TimeTraceScope scope("ir optimize function", name);
+    trace("StrengthReduce", name, [&]() { StrengthReduce(cfg, symbol_table); });
+    if (options.bounds_check && trace("InsertBoundsChecks", name, [&]() { return InsertBoundsChecks(cfg, symbol_table, name, options); }))
+    {
+        cfg = ConstructCFG(ir_list);
+    }
+
+    if (options.vectorize && trace("VectorizeLoops", name, [&]() { return VectorizeLoops(cfg, symbol_table, name, options); }))
+    {
+        cfg = ConstructCFG(ir_list);
+    }
+
+    if (trace("UnrollLoops", name, [&]() { return UnrollLoops(cfg, symbol_table, name, options); }))
+    {
+        cfg = ConstructCFG(ir_list);
+    }
+
+    trace("CoalesceTemps", name, [&]() { CoalesceTemps(cfg, symbol_table); });
+}
+
+/**
+ * Optimizes the IR for the program. If find_cached is given, it is called after the interprocedural passes with the
+ * functions, and the functions it returns were loaded from the compile cache, so they are not optimized again.
+ */
+void Program::ir_optimize(const Options& options, const std::function<std::set<FunctionDef *>(std::vector<std::shared_ptr<FunctionDef>>&)>& find_cached)
+{
+    trace("SpecializeFunctions", "", [&]() { SpecializeFunctions(functions, options); });
+    trace("RemoveDeadFunctions", "", [&]() { RemoveDeadFunctions(functions, options); });
+    trace("PromoteGlobals", "", [&]() { PromoteGlobals(functions, options); });
+
+    auto cached = find_cached ? find_cached(functions) : std::set<FunctionDef *>();
+    for (auto& f : functions)
+    {
+        if (cached.find(f.get()) == cached.end())
+        {
+            f->ir_optimize(options);
+        }
+    }
+
+    trace("InferFunctionAttributes", "", [&]() { InferFunctionAttributes(functions, options); });
+}
@@ -0,0 +1,253 @@
+#include <map>
+#include <algorithm>
+#include "CallGraph.hpp"
+#include "Interprocedural.hpp"
+
+// the most quads a function can have to be specialized, since the clone is a copy of the whole body
+const int max_specialized_quads = 256;
+
+// the most clones made for a program
+const int max_clones = 16;
+
+/**
+ * Copies the operand, so that passes that change operands in place do not change both functions. Labels are shared,
+ * since jumps find their label by its operand.
+ */
+static std::shared_ptr<Operand> copy_operand(std::shared_ptr<Operand> operand)
+{
+    return operand != nullptr && operand->type != OperandType::Label ? std::make_shared<Operand>(*operand) : operand;
+}
+
+/**
+ * Makes a copy of the function's quads for the clone, which enters the new function symbol, and sets each constant
+ * parameter on entry. Each use of a constant parameter that is never written is also replaced by the constant, so that
+ * the optimizations within the clone see it.
+ */
+static QuadList clone_quads(std::shared_ptr<FunctionDef> def, std::shared_ptr<Symbol> function, std::map<Symbol *, long>& constant_params)
+{
+    QuadList ir_list;
+    std::set<Symbol *> written;
+    for (auto quad = def->ir_list.begin(); quad != def->ir_list.end(); quad = quad->next)
+    {
+        auto copy = std::make_shared<Quad>(*quad);
+        copy->next = nullptr;
+        copy->arg1 = copy_operand(quad->arg1);
+        copy->arg2 = copy_operand(quad->arg2);
+        copy->res = copy_operand(quad->res);
+        ir_list.push_back(copy);
+
+        auto def_operand = quad->def();
+        if (def_operand != nullptr)
+        {
+            written.insert(def_operand->symbol.get());
+        }
+        else if (quad->op == QuadOp::AddrOf)
+        {
+            written.insert(quad->arg1->symbol.get());
+        }
+    }
+
+    ir_list.get_head()->arg1 = Operand::MakeVariableOperand(function);
+    for (auto quad = ir_list.begin(); quad != ir_list.end(); quad = quad->next)
+    {
+        if (quad->op == QuadOp::Cast || quad->op == QuadOp::AddrOf)
+        {
+            continue;
+        }
+
+        for (auto operand : { &quad->arg1, &quad->arg2 })
+        {
+            auto symbol = *operand != nullptr && (*operand)->type == OperandType::Variable ? (*operand)->symbol.get() : nullptr;
+            if (constant_params.find(symbol) != constant_params.end() && written.find(symbol) == written.end())
+            {
+                *operand = Operand::MakeIntConstOperand(constant_params[symbol]);
+            }
+        }
+    }
+
+    for (auto& param : def->params)
+    {
+        if (constant_params.find(param.get()) != constant_params.end())
+        {
+            auto value = Operand::MakeIntConstOperand(constant_params[param.get()]);
+            ir_list.insert_after(ir_list.get_head(), Quad::MakeUnOp(QuadOp::Copy, value, Operand::MakeVariableOperand(param)));
+        }
+    }
+
+    return ir_list;
+}
+
+/**
+ * Finds the int parameters that every call to the function passes the same constant for.
+ */
+static std::vector<std::optional<long>> find_constant_params(std::shared_ptr<FunctionDef> def, std::vector<CallSite>& sites)
+{
+    std::vector<std::optional<long>> constants;
+    for (auto i = 0; i < def->params.size(); i++)
+    {
+        std::optional<long> constant = sites.front().constants[i];
+        for (auto& site : sites)
+        {
+            constant = site.constants[i] == constant ? constant : std::nullopt;
+        }
+
+        constants.push_back(def->params[i]->type->type == TypeType::Int ? constant : std::nullopt);
+    }
+
+    return constants;
+}
+
+/**
+ * Specializes the function for the constants it is always called with. The calls are changed to call a clone that
+ * does not take the constant parameters, and the clone is added after the function. The whole program is visible, so
+ * nothing calls the function itself any more.
+ */
+static void specialize(std::vector<std::shared_ptr<FunctionDef>>& functions, std::shared_ptr<FunctionDef> def, std::vector<CallSite>& sites, std::vector<std::optional<long>>& constants, const Options& options)
+{
+    auto name = def->function->get_name();
+    auto type = std::make_shared<Type>(*def->function->type);
+    type->param_types.clear();
+
+    std::vector<std::shared_ptr<Symbol>> params;
+    std::map<Symbol *, long> constant_params;
+    std::string description;
+    for (auto i = 0; i < def->params.size(); i++)
+    {
+        if (constants[i])
+        {
+            constant_params[def->params[i].get()] = constants[i].value();
+            name += "." + std::to_string(constants[i].value());
+            description += (description.empty() ? "" : ", ") + def->params[i]->get_source_name() + " = " + std::to_string(constants[i].value());
+        }
+        else
+        {
+            params.push_back(def->params[i]);
+            type->param_types.push_back(def->function->type->param_types[i]);
+        }
+    }
+
+    auto function = std::make_shared<Symbol>(name, type, GLOBAL_SCOPE);
+
+    // the calls are changed first, so that recursive calls in the clone call the clone
+    std::set<FunctionDef *> callers;
+    for (auto& site : sites)
+    {
+        site.call->arg1 = Operand::MakeVariableOperand(function);
+        site.call->arg2 = Operand::MakeIntConstOperand(params.size());
+        for (auto i = 0; i < site.params.size(); i++)
+        {
+            if (constants[i])
+            {
+                site.caller->ir_list.remove(site.params[i]);
+            }
+        }
+
+        callers.insert(site.caller.get());
+    }
+
+    for (auto caller : callers)
+    {
+        caller->cfg = ConstructCFG(caller->ir_list);
+    }
+
+    auto clone = std::make_shared<FunctionDef>(def->span, function, params, def->body, def->symbol_table);
+    clone->ir_list = clone_quads(def, function, constant_params);
+    clone->cfg = ConstructCFG(clone->ir_list);
+    clone->attributes.internal = true;
+    functions.insert(std::find(functions.begin(), functions.end(), def) + 1, clone);
+
+    // callers may come before the definition, after a prototype, so the clone needs a prototype there too
+    auto first = std::find_if(functions.begin(), functions.end(), [&](std::shared_ptr<FunctionDef>& f) { return f->function == def->function; });
+    if (*first != def)
+    {
+        auto proto = std::make_shared<FunctionDef>(def->span, function, params, def->symbol_table);
+        proto->attributes.internal = true;
+        functions.insert(first + 1, proto);
+    }
+
+    // the function is dead now, and removing it right away keeps its calls from blocking other specializations
+    functions.erase(std::find(functions.begin(), functions.end(), def));
+
+    options.remark("ipcp", def->function->get_name(), "specialized for " + description + " as " + name + " (" + std::to_string(sites.size()) + (sites.size() == 1 ? " call)" : " calls)"));
+}
+
+/**
+ * Specializes functions that are always called with the same constant arguments. The functions are visited top down
+ * in the call graph, so that the constants passed on by a specialized function can specialize the functions it calls.
+ * Recursive functions are not specialized. This is only done when the whole program is visible, since otherwise the
+ * original must be kept for calls from other files, and the clone would only grow the code.
+ */
+void SpecializeFunctions(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options)
+{
+    if (!options.whole_program)
+    {
+        return;
+    }
+
+    auto clones = 0;
+    CallGraph graph(functions);
+    auto sccs = graph.sccs();
+    for (auto scc = sccs.rbegin(); scc != sccs.rend(); scc++)
+    {
+        auto function = scc->front();
+        if (scc->size() > 1 || graph.callees[function].count(function) > 0 || function->get_name() == "main")
+        {
+            continue;
+        }
+
+        auto def = graph.definitions[function];
+        auto call_sites = FindCallSites(functions);
+        auto& sites = call_sites[function];
+        if (sites.empty() || def->params.empty())
+        {
+            continue;
+        }
+
+        auto constants = find_constant_params(def, sites);
+        if (std::none_of(constants.begin(), constants.end(), [](std::optional<long>& c) { return c.has_value(); }))
+        {
+            continue;
+        }
+
+        auto quads = count_quads(def->cfg);
+        if (quads > max_specialized_quads)
+        {
+            options.remark("ipcp", function->get_name(), "not specialized, since its " + std::to_string(quads) + " quads are more than " + std::to_string(max_specialized_quads));
+        }
+        else if (clones >= max_clones)
+        {
+            options.remark("ipcp", function->get_name(), "not specialized, since " + std::to_string(max_clones) + " functions already were");
+        }
+        else
+        {
+            specialize(functions, def, sites, constants, options);
+            clones++;
+        }
+    }
+}
+
+/**
+ * Removes the functions that main can not reach by calls, and their prototypes. This is only done when the whole
+ * program is visible, since otherwise other files may call them.
+ */
+void RemoveDeadFunctions(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options)
+{
+    CallGraph graph(functions);
+    auto main = std::find_if(graph.definitions.begin(), graph.definitions.end(), [](auto& kv) { return kv.first->get_name() == "main"; });
+    if (!options.whole_program || main == graph.definitions.end())
+    {
+        return;
+    }
+
+    auto reachable = graph.reachable_from(main->first);
+    for (auto& [function, def] : graph.definitions)
+    {
+        if (reachable.find(function) == reachable.end())
+        {
+            options.remark("globaldce", function->get_name(), "removed unreferenced function");
+        }
+    }
+
+    auto is_dead = [&](std::shared_ptr<FunctionDef>& f) { return reachable.find(f->function.get()) == reachable.end(); };
+    functions.erase(std::remove_if(functions.begin(), functions.end(), is_dead), functions.end());
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "SyntaxTree.hpp"
+#include "Options.hpp"
+
+void SpecializeFunctions(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options);
+void RemoveDeadFunctions(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options);
@@ -0,0 +1,243 @@
+#include <map>
+#include <set>
+#include <cassert>
+#include "Liveness.hpp"
+
+static bool is_tracked(std::shared_ptr<Operand> operand);
+static std::set<Symbol *> unique_uses(std::shared_ptr<Quad> quad);
+
+/**
+ * Computes the live-in and live-out sets of each basic block with a backward dataflow analysis,
+ * and the maximum number of simultaneously live variables within each block.
+ */
+void ComputeLiveness(std::vector<std::shared_ptr<BasicBlock>>& cfg)
+{
+    // compute the upward exposed uses and the definitions of each block
+    std::map<BasicBlock *, std::set<Symbol *>> use;
+    std::map<BasicBlock *, std::set<Symbol *>> def;
+    for (auto& block : cfg)
+    {
+        auto& block_use = use[block.get()];
+        auto& block_def = def[block.get()];
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            for (auto symbol : unique_uses(quad))
+            {
+                if (block_def.find(symbol) == block_def.end())
+                {
+                    block_use.insert(symbol);
+                }
+            }
+
+            auto res = quad->def();
+            if (is_tracked(res))
+            {
+                block_def.insert(res->symbol.get());
+            }
+        }
+
+        block->live_in.clear();
+        block->live_out.clear();
+    }
+
+    // iterate to a fixed point, visiting blocks in reverse order since the analysis flows backward
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto it = cfg.rbegin(); it != cfg.rend(); it++)
+        {
+            auto block = it->get();
+            std::set<Symbol *> live_out;
+            for (auto succ : block->out)
+            {
+                live_out.insert(succ->live_in.begin(), succ->live_in.end());
+            }
+
+            auto live_in = use[block];
+            for (auto symbol : live_out)
+            {
+                if (def[block].find(symbol) == def[block].end())
+                {
+                    live_in.insert(symbol);
+                }
+            }
+
+            if (live_in != block->live_in || live_out != block->live_out)
+            {
+                block->live_in = live_in;
+                block->live_out = live_out;
+                changed = true;
+            }
+        }
+    }
+
+    // walk each block backward to find the register pressure at each point
+    for (auto& block : cfg)
+    {
+        std::vector<std::shared_ptr<Quad>> quads;
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            quads.push_back(quad);
+        }
+
+        auto live = block->live_out;
+        block->max_live = live.size();
+        for (auto it = quads.rbegin(); it != quads.rend(); it++)
+        {
+            auto res = (*it)->def();
+            if (is_tracked(res))
+            {
+                live.erase(res->symbol.get());
+            }
+
+            for (auto symbol : unique_uses(*it))
+            {
+                live.insert(symbol);
+            }
+
+            block->max_live = std::max(block->max_live, live.size());
+        }
+    }
+}
+
+/**
+ * Reuses the symbols of dead temporaries for new temporaries of the same type, so that the number of temporaries
+ * in a function is bounded by the register pressure rather than by the number of subexpressions.
+ * Only temporaries with a single definition that never live across a block boundary are coalesced.
+ */
+void CoalesceTemps(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table)
+{
+    ComputeLiveness(cfg);
+
+    std::map<Symbol *, int> def_count;
+    std::set<Symbol *> crosses_block;
+    for (auto& block : cfg)
+    {
+        crosses_block.insert(block->live_in.begin(), block->live_in.end());
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            auto res = quad->def();
+            if (is_tracked(res))
+            {
+                def_count[res->symbol.get()]++;
+            }
+        }
+    }
+
+    auto is_candidate = [&](Symbol *symbol) 
+    {
+        return symbol->is_temp && def_count[symbol] == 1 && crosses_block.find(symbol) == crosses_block.end();
+    };
+
+    // assign each candidate a representative symbol by scanning the blocks with a free list of dead temporaries
+    std::map<Symbol *, std::shared_ptr<Symbol>> rep;
+    std::vector<std::shared_ptr<Symbol>> free_list;
+
+    auto acquire = [&](std::shared_ptr<Symbol> temp)
+    {
+        for (auto it = free_list.rbegin(); it != free_list.rend(); it++)
+        {
+            if (*(*it)->type == *temp->type)
+            {
+                auto symbol = *it;
+                free_list.erase(std::next(it).base());
+                return symbol;
+            }
+        }
+
+        return temp;
+    };
+
+    for (auto& block : cfg)
+    {
+        std::map<Symbol *, std::shared_ptr<Quad>> last_use;
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            for (auto symbol : unique_uses(quad))
+            {
+                last_use[symbol] = quad;
+            }
+        }
+
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            for (auto symbol : unique_uses(quad))
+            {
+                if (is_candidate(symbol) && last_use[symbol] == quad)
+                {
+                    assert(rep.find(symbol) != rep.end());
+                    free_list.push_back(rep[symbol]);
+                }
+            }
+
+            auto res = quad->def();
+            if (is_tracked(res) && is_candidate(res->symbol.get()))
+            {
+                auto symbol = res->symbol.get();
+                rep[symbol] = acquire(res->symbol);
+                if (last_use.find(symbol) == last_use.end())
+                {
+                    // the temporary is never read, so it is dead immediately
+                    free_list.push_back(rep[symbol]);
+                }
+            }
+        }
+    }
+
+    // rename the operands, and drop the temporaries that are no longer referenced
+    std::set<Symbol *> dead;
+    for (auto& kv : rep)
+    {
+        if (kv.first != kv.second.get())
+        {
+            dead.insert(kv.first);
+        }
+    }
+
+    for (auto& block : cfg)
+    {
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            for (auto operand : { quad->arg1, quad->arg2, quad->res })
+            {
+                if (is_tracked(operand) && dead.find(operand->symbol.get()) != dead.end())
+                {
+                    operand->symbol = rep[operand->symbol.get()];
+                }
+            }
+        }
+    }
+
+    symbol_table->remove_temps(dead);
+    ComputeLiveness(cfg);
+}
+
+/**
+ * Determines if the operand is a variable whose value can be held in a register.
+ * Globals and arrays live in memory, so they are not tracked.
+ */
+static bool is_tracked(std::shared_ptr<Operand> operand)
+{
+    return operand != nullptr 
+        && operand->type == OperandType::Variable 
+        && operand->symbol->scope != GLOBAL_SCOPE
+        && operand->symbol->type->type != TypeType::Array;
+}
+
+/**
+ * Gets the tracked symbols read by the quad, without duplicates.
+ */
+static std::set<Symbol *> unique_uses(std::shared_ptr<Quad> quad)
+{
+    std::set<Symbol *> symbols;
+    for (auto& operand : quad->uses())
+    {
+        if (is_tracked(operand))
+        {
+            symbols.insert(operand->symbol.get());
+        }
+    }
+
+    return symbols;
+}
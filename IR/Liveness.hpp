@@ -0,0 +1,8 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "CFG.hpp"
+
+void ComputeLiveness(std::vector<std::shared_ptr<BasicBlock>>& cfg);
+void CoalesceTemps(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table);
@@ -0,0 +1,390 @@
+#include <map>
+#include <optional>
+#include "Loop.hpp"
+
+/**
+ * Gets a name for the loop to use in reports.
+ */
+std::string Loop::name()
+{
+    if (induction != nullptr)
+    {
+        return "loop over " + induction->get_source_name();
+    }
+
+    return "loop at " + body->qlist.get_head()->arg1->strconst;
+}
+
+/**
+ * Gets the number of times the loop runs, if the induction variable starts at a constant and the bound is a constant.
+ */
+std::optional<long> Loop::trip_count()
+{
+    if (!is_counted || !start || bound->type != OperandType::IntConst)
+    {
+        return {};
+    }
+
+    // the constants must be values of the induction variable, or the comparison would wrap around
+    auto min = induction->type->min_value();
+    auto max = induction->type->max_value();
+    if (start.value() < min || start.value() > max || bound->iconst < min || bound->iconst > max - step)
+    {
+        return {};
+    }
+
+    auto end = compare == QuadOp::IfLeq ? bound->iconst + 1 : bound->iconst;
+    if (end <= start.value())
+    {
+        return 0;
+    }
+
+    return (end - start.value() + step - 1) / step;
+}
+
+/**
+ * Inserts quads between the preheader and this loop, that run once before it and then go to the guard. The quads may
+ * also branch to the guard, whose label is the target of the goto at the end of the preheader.
+ *     goto before
+ *     label before
+ *     quads
+ *     goto guard
+ */
+void Loop::insert_before(std::vector<std::shared_ptr<Quad>>& quads)
+{
+    auto entry = preheader->qlist.get_tail();
+    auto guard_label = entry->arg1;
+    auto before_label = Operand::MakeLabelOperand();
+    entry->arg1 = before_label;
+
+    std::shared_ptr<Quad> pos = Quad::MakeLabelOp(before_label);
+    preheader->qlist.insert_after(entry, pos);
+    for (auto& quad : quads)
+    {
+        preheader->qlist.insert_after(pos, quad);
+        pos = quad;
+    }
+
+    preheader->qlist.insert_after(pos, Quad::MakeGotoOp(guard_label));
+}
+
+/**
+ * Inserts a loop between the preheader and this loop that runs while at least the given number of iterations remain,
+ * e.g. a vector or unrolled copy of this loop, then this loop runs the iterations that are left. The body must advance
+ * the induction variable by that many iterations, and the setup quads run once before the inserted loop.
+ *     goto before
+ *     label before
+ *     setup
+ *     limit = bound - (iterations - 1) * step
+ *     if (limit > bound) goto guard
+ *     if (i < limit) goto top
+ *     goto guard
+ *     label top
+ *     body
+ *     if (i < limit) goto top
+ *     goto guard
+ */
+void Loop::insert_before(std::vector<std::shared_ptr<Quad>>& setup, std::vector<std::shared_ptr<Quad>>& body, int iterations, std::shared_ptr<SymbolTable> symbol_table)
+{
+    auto guard_label = preheader->qlist.get_tail()->arg1;
+    auto top_label = Operand::MakeLabelOperand();
+    auto i = Operand::MakeVariableOperand(induction);
+    auto distance = (iterations - 1) * step;
+
+    std::vector<std::shared_ptr<Quad>> quads(setup);
+
+    std::shared_ptr<Operand> limit;
+    if (bound->type == OperandType::IntConst)
+    {
+        limit = Operand::MakeIntConstOperand(bound->iconst - distance);
+    }
+    else
+    {
+        // if the bound is so small that the subtraction wraps around, only this loop runs
+        limit = Operand::MakeVariableOperand(symbol_table->new_temp(induction->type));
+        auto subtract = Quad::MakeBinOp(QuadOp::Sub, bound, Operand::MakeIntConstOperand(distance), limit);
+        subtract->wraps = true;
+        quads.push_back(subtract);
+        quads.push_back(Quad::MakeIfOp(QuadOp::IfGt, limit, bound, guard_label));
+    }
+
+    quads.push_back(Quad::MakeIfOp(compare, i, limit, top_label));
+    quads.push_back(Quad::MakeGotoOp(guard_label));
+    // the inserted loop already does the work of several iterations, so it is not unrolled again
+    auto top = Quad::MakeLabelOp(top_label);
+    top->unroll = 1;
+    quads.push_back(top);
+    quads.insert(quads.end(), body.begin(), body.end());
+    quads.push_back(Quad::MakeIfOp(compare, i, limit, top_label));
+    insert_before(quads);
+}
+
+/**
+ * Determines if the quad op is a conditional branch.
+ */
+static bool is_if(QuadOp op)
+{
+    return op == QuadOp::IfEq || op == QuadOp::IfNeq || op == QuadOp::IfLt || op == QuadOp::IfLeq || op == QuadOp::IfGt || op == QuadOp::IfGeq;
+}
+
+/**
+ * Finds the only quad in the block that defines the symbol, or nullptr if there is not exactly one.
+ */
+static std::shared_ptr<Quad> find_def(std::shared_ptr<Symbol> symbol, std::shared_ptr<BasicBlock> block)
+{
+    std::shared_ptr<Quad> found;
+    for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+    {
+        auto def = quad->def();
+        if (def != nullptr && def->symbol == symbol)
+        {
+            if (found != nullptr)
+            {
+                return nullptr;
+            }
+
+            found = quad;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * Gets the value of an operand that is an int constant, or a temp defined in the block by a copy of one.
+ * If the value comes from a copy, the copy is returned in def.
+ */
+static std::optional<long> get_constant(std::shared_ptr<Operand> operand, std::shared_ptr<BasicBlock> block, std::shared_ptr<Quad> *def = nullptr)
+{
+    if (operand->type == OperandType::IntConst)
+    {
+        return operand->iconst;
+    }
+    else if (operand->type != OperandType::Variable || !operand->symbol->is_temp)
+    {
+        return {};
+    }
+
+    auto quad = find_def(operand->symbol, block);
+    if (quad == nullptr || quad->op != QuadOp::Copy || quad->arg1->type != OperandType::IntConst)
+    {
+        return {};
+    }
+
+    if (def != nullptr)
+    {
+        *def = quad;
+    }
+
+    return quad->arg1->iconst;
+}
+
+/**
+ * Determines if the block writes the symbol, or calls a function that might.
+ */
+static bool may_write(std::shared_ptr<Symbol> symbol, std::shared_ptr<BasicBlock> block)
+{
+    for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+    {
+        auto def = quad->def();
+        if (quad->op == QuadOp::Call || (def != nullptr && def->symbol == symbol))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Finds the quads that step the induction variable, which must be the last quads of the body,
+ * i.e. either i = i + c, or t = i + c; i = t. Returns the step, or 0 if there is no such update.
+ */
+static long find_update(Loop& loop)
+{
+    auto last = loop.body->qlist.get_tail();
+    auto def = last->def();
+    if (def == nullptr || def->symbol != loop.induction || find_def(loop.induction, loop.body) != last)
+    {
+        return 0;
+    }
+
+    auto add = last;
+    if (last->op == QuadOp::Copy && last->arg1->type == OperandType::Variable && last->arg1->symbol->is_temp)
+    {
+        add = find_def(last->arg1->symbol, loop.body);
+        if (add == nullptr)
+        {
+            return 0;
+        }
+    }
+
+    if (add->op != QuadOp::Add || add->arg1->type != OperandType::Variable || add->arg1->symbol != loop.induction)
+    {
+        return 0;
+    }
+
+    std::shared_ptr<Quad> step_def;
+    auto step = get_constant(add->arg2, loop.body, &step_def);
+    if (!step || step.value() <= 0)
+    {
+        return 0;
+    }
+
+    loop.update = { last.get(), add.get() };
+    if (step_def != nullptr)
+    {
+        loop.update.insert(step_def.get());
+    }
+
+    return step.value();
+}
+
+/**
+ * Finds the constant that the preheader sets the induction variable to, if its last write is a copy of one.
+ */
+static std::optional<long> find_start(Loop& loop)
+{
+    std::shared_ptr<Quad> last;
+    for (auto quad = loop.preheader->qlist.begin(); quad != loop.preheader->qlist.end(); quad = quad->next)
+    {
+        auto def = quad->def();
+        if (def != nullptr && def->symbol == loop.induction)
+        {
+            last = quad;
+        }
+        else if (quad->op == QuadOp::Call)
+        {
+            // the call might write the induction variable if it is global
+            last = nullptr;
+        }
+    }
+
+    if (last == nullptr || last->op != QuadOp::Copy)
+    {
+        return {};
+    }
+
+    return get_constant(last->arg1, loop.preheader);
+}
+
+/**
+ * Determines if the loop is counted, and fills in the induction variable, bound and step if it is.
+ * Returns the reason if it is not.
+ */
+static std::string analyze(Loop& loop, int body_index, int guard_index)
+{
+    auto branch = loop.guard->qlist.get_tail();
+    if (branch->op == QuadOp::Goto)
+    {
+        return "loop has no condition";
+    }
+
+    if (branch->arg1->type == OperandType::Variable && !branch->arg1->symbol->is_temp)
+    {
+        loop.induction = branch->arg1->symbol;
+    }
+
+    if (body_index != guard_index - 1 || is_if(loop.body->qlist.get_tail()->op) || loop.body->qlist.get_tail()->op == QuadOp::Goto)
+    {
+        return "loop body has control flow";
+    }
+
+    if (loop.preheader == nullptr || loop.preheader->qlist.get_tail()->op != QuadOp::Goto ||
+        loop.preheader->qlist.get_tail()->arg1->strconst != loop.guard->qlist.get_head()->arg1->strconst)
+    {
+        return "loop is not entered through its condition";
+    }
+
+    if (branch->op != QuadOp::IfLt && branch->op != QuadOp::IfLeq)
+    {
+        return "loop condition is not a < or <= comparison";
+    }
+
+    if (loop.induction == nullptr || !loop.induction->type->is_integer())
+    {
+        return "loop condition does not compare an integer variable";
+    }
+
+    // the guard may only compute the constants it compares against
+    for (auto quad = loop.guard->qlist.begin(); quad != branch; quad = quad->next)
+    {
+        if (quad->op != QuadOp::Label && !(quad->op == QuadOp::Copy && quad->arg1->type == OperandType::IntConst))
+        {
+            return "loop bound is not invariant";
+        }
+    }
+
+    auto constant = get_constant(branch->arg2, loop.guard);
+    if (constant)
+    {
+        loop.bound = Operand::MakeIntConstOperand(constant.value());
+    }
+    else if (branch->arg2->type == OperandType::Variable && !branch->arg2->symbol->is_temp && !may_write(branch->arg2->symbol, loop.body))
+    {
+        loop.bound = branch->arg2;
+    }
+    else
+    {
+        return "loop bound is not invariant";
+    }
+
+    loop.compare = branch->op;
+    loop.step = find_update(loop);
+    if (loop.step == 0)
+    {
+        return "induction variable is not increased by a constant at the end of the body";
+    }
+
+    loop.start = find_start(loop);
+
+    return "";
+}
+
+/**
+ * Finds the loops in the CFG, in the order that their bodies appear.
+ */
+std::vector<Loop> FindLoops(std::vector<std::shared_ptr<BasicBlock>>& cfg)
+{
+    std::map<std::string, int> label_index;
+    for (auto i = 0; i < cfg.size(); i++)
+    {
+        auto head = cfg[i]->qlist.get_head();
+        if (head->op == QuadOp::Label)
+        {
+            label_index[head->arg1->strconst] = i;
+        }
+    }
+
+    std::vector<Loop> loops;
+    for (auto i = 0; i < cfg.size(); i++)
+    {
+        auto tail = cfg[i]->qlist.get_tail();
+        std::shared_ptr<Operand> target;
+        if (is_if(tail->op))
+        {
+            target = tail->res;
+        }
+        else if (tail->op == QuadOp::Goto)
+        {
+            target = tail->arg1;
+        }
+
+        // a branch to an earlier block is the back edge of a loop
+        if (target == nullptr || label_index[target->strconst] > i)
+        {
+            continue;
+        }
+
+        auto body_index = label_index[target->strconst];
+        Loop loop;
+        loop.preheader = body_index > 0 ? cfg[body_index - 1] : nullptr;
+        loop.body = cfg[body_index];
+        loop.guard = cfg[i];
+        loop.reason = analyze(loop, body_index, i);
+        loop.is_counted = loop.reason.empty();
+        loops.push_back(loop);
+    }
+
+    return loops;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <set>
+#include <string>
+#include <optional>
+#include "CFG.hpp"
+
+/**
+ * Represents a loop in the CFG, i.e. a block that branches back to itself or to an earlier block.
+ *
+ * A loop is counted if it has the shape generated for a for or while loop with a single block body
+ * and a guard that compares an induction variable against an invariant bound:
+ *     preheader: ...; goto guard
+ *     body:      label top; ...; i = i + step
+ *     guard:     label guard; if (i < bound) goto top
+ * Otherwise reason says why it is not.
+ */
+struct Loop
+{
+    std::shared_ptr<BasicBlock> preheader;
+    std::shared_ptr<BasicBlock> body;
+    std::shared_ptr<BasicBlock> guard;
+
+    bool is_counted = false;
+    std::string reason;
+
+    /* for counted loops */
+    std::shared_ptr<Symbol> induction;
+    std::shared_ptr<Operand> bound;     // an int constant, or a variable that is not written in the body
+    QuadOp compare;                     // IfLt or IfLeq
+    long step = 0;                      // the constant added to the induction variable in each iteration
+    std::set<Quad *> update;            // the quads in the body that step the induction variable
+    std::optional<long> start;          // the constant the induction variable is set to in the preheader, if any
+
+    std::string name();
+    std::optional<long> trip_count();
+    void insert_before(std::vector<std::shared_ptr<Quad>>& quads);
+    void insert_before(std::vector<std::shared_ptr<Quad>>& setup, std::vector<std::shared_ptr<Quad>>& body, int iterations, std::shared_ptr<SymbolTable> symbol_table);
+};
+
+std::vector<Loop> FindLoops(std::vector<std::shared_ptr<BasicBlock>>& cfg);
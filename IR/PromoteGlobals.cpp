@@ -0,0 +1,279 @@
+#include <map>
+#include <algorithm>
+#include "CallGraph.hpp"
+#include "PromoteGlobals.hpp"
+
+/**
+ * Gets the labels the quad may jump to.
+ */
+static std::vector<std::string> get_targets(std::shared_ptr<Quad> quad)
+{
+    std::vector<std::string> targets;
+    switch (quad->op)
+    {
+        case QuadOp::Goto:
+            targets.push_back(quad->arg1->strconst);
+            break;
+        case QuadOp::IfEq:
+        case QuadOp::IfNeq:
+        case QuadOp::IfLt:
+        case QuadOp::IfLeq:
+        case QuadOp::IfGt:
+        case QuadOp::IfGeq:
+            targets.push_back(quad->res->strconst);
+            break;
+        case QuadOp::Switch:
+            targets.push_back(quad->res->strconst);
+            for (auto& [value, label] : quad->cases)
+            {
+                targets.push_back(label->strconst);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return targets;
+}
+
+/**
+ * Estimates how often each quad runs, relative to the entry of the function. A quad between a label and a
+ * later jump back to it is in a loop, and is assumed to run 8 times as often as the code around the loop.
+ */
+static std::map<Quad *, long> estimate_frequencies(QuadList& ir_list)
+{
+    std::vector<std::shared_ptr<Quad>> quads;
+    std::map<std::string, std::size_t> labels;
+    for (auto quad = ir_list.begin(); quad != ir_list.end(); quad = quad->next)
+    {
+        if (quad->op == QuadOp::Label)
+        {
+            labels[quad->arg1->strconst] = quads.size();
+        }
+
+        quads.push_back(quad);
+    }
+
+    std::vector<int> depths(quads.size(), 0);
+    for (std::size_t i = 0; i < quads.size(); i++)
+    {
+        for (auto& target : get_targets(quads[i]))
+        {
+            auto label = labels.find(target);
+            for (auto j = label != labels.end() ? label->second : i + 1; j <= i; j++)
+            {
+                depths[j]++;
+            }
+        }
+    }
+
+    std::map<Quad *, long> frequencies;
+    for (std::size_t i = 0; i < quads.size(); i++)
+    {
+        frequencies[quads[i].get()] = 1L << (3 * std::min(depths[i], 6));
+    }
+
+    return frequencies;
+}
+
+/**
+ * Finds the globals whose address is taken. They may be accessed through pointers, so they are never promoted.
+ */
+static std::set<Symbol *> find_escaped(std::vector<std::shared_ptr<FunctionDef>>& functions)
+{
+    std::set<Symbol *> escaped;
+    for (auto& f : functions)
+    {
+        for (auto quad = f->ir_list.begin(); quad != f->ir_list.end(); quad = quad->next)
+        {
+            if (quad->op == QuadOp::AddrOf && IsGlobalVariable(quad->arg1->symbol))
+            {
+                escaped.insert(quad->arg1->symbol.get());
+            }
+        }
+    }
+
+    return escaped;
+}
+
+/**
+ * Checks if the operand is the global.
+ */
+static bool is_global(std::shared_ptr<Operand> operand, Symbol *global)
+{
+    return operand != nullptr && operand->type == OperandType::Variable && operand->symbol.get() == global;
+}
+
+/**
+ * Checks if control can fall off the end of the function after the quad, which returns implicitly.
+ */
+static bool falls_off_end(std::shared_ptr<Quad> tail)
+{
+    return tail->op != QuadOp::Return && tail->op != QuadOp::Goto && tail->op != QuadOp::Switch;
+}
+
+/**
+ * Gets the globals the function accesses that can be promoted, i.e. scalars whose address is never taken.
+ */
+static std::vector<std::shared_ptr<Symbol>> find_candidates(FunctionDef& def, std::set<Symbol *>& escaped)
+{
+    std::vector<std::shared_ptr<Symbol>> candidates;
+    std::set<Symbol *> seen;
+    for (auto quad = def.ir_list.begin(); quad != def.ir_list.end(); quad = quad->next)
+    {
+        for (auto operand : { quad->arg1, quad->arg2, quad->res })
+        {
+            if (operand == nullptr || operand->type != OperandType::Variable || !IsGlobalVariable(operand->symbol))
+            {
+                continue;
+            }
+
+            auto global = operand->symbol;
+            if (global->type->is_arithmetic() && escaped.find(global.get()) == escaped.end() && seen.insert(global.get()).second)
+            {
+                candidates.push_back(global);
+            }
+        }
+    }
+
+    return candidates;
+}
+
+/**
+ * Decides where the promoted global has to be loaded and stored. The global is loaded into the shadow on entry and
+ * after every call that may modify it. If the function writes the global, the shadow is stored back before every
+ * call that may touch the global and before every return. Returns the estimated number of accesses to the global
+ * that promotion removes, less the number of loads and stores it adds.
+ */
+static long plan(FunctionDef& def, Symbol *global, std::map<Symbol *, ModRef>& mod_refs, std::map<Quad *, long>& frequencies,
+    std::set<Quad *>& store_before, std::set<Quad *>& load_after)
+{
+    auto writes = false;
+    for (auto quad = def.ir_list.begin(); quad != def.ir_list.end(); quad = quad->next)
+    {
+        writes = writes || is_global(quad->def(), global);
+    }
+
+    long benefit = -1; // the load on entry
+    for (auto quad = def.ir_list.begin(); quad != def.ir_list.end(); quad = quad->next)
+    {
+        auto frequency = frequencies[quad.get()];
+        for (auto operand : { quad->arg1, quad->arg2, quad->res })
+        {
+            benefit += is_global(operand, global) ? frequency : 0;
+        }
+
+        if (quad->op == QuadOp::Call)
+        {
+            auto& callee = mod_refs[quad->arg1->symbol.get()];
+            if (writes && (callee.may_ref(global) || callee.may_mod(global)))
+            {
+                store_before.insert(quad.get());
+                benefit -= frequency;
+            }
+
+            if (callee.may_mod(global))
+            {
+                load_after.insert(quad.get());
+                benefit -= frequency;
+            }
+        }
+        else if (quad->op == QuadOp::Return && writes)
+        {
+            store_before.insert(quad.get());
+            benefit -= frequency;
+        }
+    }
+
+    if (writes && falls_off_end(def.ir_list.get_tail()))
+    {
+        benefit--;
+    }
+
+    return benefit;
+}
+
+/**
+ * Replaces the global with the shadow variable in the function, loading and storing it where the plan says to.
+ */
+static void promote(FunctionDef& def, std::shared_ptr<Symbol> global, std::shared_ptr<Symbol> shadow, std::set<Quad *>& store_before, std::set<Quad *>& load_after)
+{
+    auto load = [&]() { return Quad::MakeUnOp(QuadOp::Copy, Operand::MakeVariableOperand(global), Operand::MakeVariableOperand(shadow)); };
+    auto store = [&]() { return Quad::MakeUnOp(QuadOp::Copy, Operand::MakeVariableOperand(shadow), Operand::MakeVariableOperand(global)); };
+
+    auto writes = false;
+    for (auto quad = def.ir_list.begin(); quad != def.ir_list.end(); quad = quad->next)
+    {
+        writes = writes || is_global(quad->def(), global.get());
+        for (auto operand : { &quad->arg1, &quad->arg2, &quad->res })
+        {
+            if (is_global(*operand, global.get()))
+            {
+                *operand = Operand::MakeVariableOperand(shadow);
+            }
+        }
+    }
+
+    // the first quad is the enter quad, which no quad is inserted before
+    std::shared_ptr<Quad> prev = nullptr;
+    for (auto quad = def.ir_list.begin(); quad != def.ir_list.end(); prev = quad, quad = quad->next)
+    {
+        if (store_before.find(quad.get()) != store_before.end())
+        {
+            def.ir_list.insert_after(prev, store());
+            prev = prev->next;
+        }
+
+        if (load_after.find(quad.get()) != load_after.end())
+        {
+            def.ir_list.insert_after(quad, load());
+            quad = quad->next;
+        }
+    }
+
+    if (writes && falls_off_end(def.ir_list.get_tail()))
+    {
+        def.ir_list.push_back(store());
+    }
+
+    def.ir_list.insert_after(def.ir_list.get_head(), load());
+}
+
+/**
+ * Promotes the globals each function accesses to local variables, so that they can be kept in registers across the
+ * code that does not call a function that may touch them. The call graph's mod/ref sets say which calls those are.
+ * A global is only promoted if the estimated number of accesses removed is more than the loads and stores added.
+ */
+void PromoteGlobals(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options)
+{
+    CallGraph graph(functions);
+    auto mod_refs = ComputeModRef(graph, options.whole_program);
+    auto escaped = find_escaped(functions);
+
+    for (auto& [function, def] : graph.definitions)
+    {
+        auto changed = false;
+        auto frequencies = estimate_frequencies(def->ir_list);
+        for (auto& global : find_candidates(*def, escaped))
+        {
+            std::set<Quad *> store_before;
+            std::set<Quad *> load_after;
+            auto benefit = plan(*def, global.get(), mod_refs, frequencies, store_before, load_after);
+            if (benefit <= 0)
+            {
+                options.remark("promote-globals", function->get_name(), "global " + global->get_name() + " not promoted: the loads and stores it needs cost more than the accesses it saves");
+                continue;
+            }
+
+            auto shadow = def->symbol_table->new_variable(global->type);
+            promote(*def, global, shadow, store_before, load_after);
+            changed = true;
+            options.remark("promote-globals", function->get_name(), "promoted global " + global->get_name() + " to " + shadow->get_name() + ", saving an estimated " + std::to_string(benefit) + " accesses per call");
+        }
+
+        if (changed)
+        {
+            def->cfg = ConstructCFG(def->ir_list);
+        }
+    }
+}
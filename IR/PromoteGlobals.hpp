@@ -0,0 +1,8 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "SyntaxTree.hpp"
+#include "Options.hpp"
+
+void PromoteGlobals(std::vector<std::shared_ptr<FunctionDef>>& functions, const Options& options);
@@ -14,6 +14,14 @@ std::shared_ptr<Operand> Operand::MakeIntConstOperand(long val)
     return std::make_shared<Operand>(OperandType::IntConst, val);
 }
 
+/**
+ * Makes a float constant operand.
+ */
+std::shared_ptr<Operand> Operand::MakeFloatConstOperand(double val)
+{
+    return std::make_shared<Operand>(OperandType::FloatConst, val);
+}
+
 /**
  * Makes a str constant operand.
  */
@@ -69,7 +77,11 @@ std::shared_ptr<Quad> Quad::MakeStringOp(std::shared_ptr<Operand> arg1)
  */
 std::shared_ptr<Quad> Quad::MakeBinOp(QuadOp op, std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> arg2, std::shared_ptr<Operand> res)
 {
-    assert(op == QuadOp::Add || op == QuadOp::Sub || op == QuadOp::Mul || op == QuadOp::Div || op == QuadOp::Mod);
+    assert(op == QuadOp::Add || op == QuadOp::Sub || op == QuadOp::Mul || op == QuadOp::Div || op == QuadOp::Mod ||
+        op == QuadOp::Eq || op == QuadOp::Neq || op == QuadOp::Lt || op == QuadOp::Leq || op == QuadOp::Gt || op == QuadOp::Geq ||
+        op == QuadOp::And || op == QuadOp::Or || op == QuadOp::BitAnd || op == QuadOp::BitOr || op == QuadOp::BitXor ||
+        op == QuadOp::Shl || op == QuadOp::Shr || op == QuadOp::MulHi ||
+        op == QuadOp::FAdd || op == QuadOp::FSub || op == QuadOp::FMul || op == QuadOp::FDiv);
     return std::make_shared<Quad>(op, arg1, arg2, res);
 }
 
@@ -78,7 +90,7 @@ std::shared_ptr<Quad> Quad::MakeBinOp(QuadOp op, std::shared_ptr<Operand> arg1,
  */
 std::shared_ptr<Quad> Quad::MakeUnOp(QuadOp op, std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> res)
 {
-    assert(op == QuadOp::Neg || op == QuadOp::RDeref || op == QuadOp::AddrOf || op == QuadOp::Copy);
+    assert(op == QuadOp::Neg || op == QuadOp::FNeg || op == QuadOp::Not || op == QuadOp::BitNot || op == QuadOp::RDeref || op == QuadOp::AddrOf || op == QuadOp::Copy || op == QuadOp::Cast || op == QuadOp::Splat);
     return std::make_shared<Quad>(op, arg1, nullptr, res);
 }
 
@@ -131,6 +143,15 @@ std::shared_ptr<Quad> Quad::MakeAddPtrOp(std::shared_ptr<Operand> arg1, std::sha
     return std::make_shared<Quad>(QuadOp::AddPtr, arg1, arg2, res);
 }
 
+/**
+ * Makes a bounds check quad operation.
+ */
+std::shared_ptr<Quad> Quad::MakeCheckOp(std::shared_ptr<Operand> index, std::shared_ptr<Operand> size)
+{
+    assert(size->type == OperandType::IntConst);
+    return std::make_shared<Quad>(QuadOp::Check, index, size, nullptr);
+}
+
 /**
  * Makes a label quad operation.
  */
@@ -156,6 +177,17 @@ std::shared_ptr<Quad> Quad::MakeIfOp(QuadOp op, std::shared_ptr<Operand> arg1, s
     return std::make_shared<Quad>(op, arg1, arg2, res);
 }
 
+/**
+ * Makes a switch quad operation.
+ */
+std::shared_ptr<Quad> Quad::MakeSwitchOp(std::shared_ptr<Operand> arg1, std::vector<std::pair<long, std::shared_ptr<Operand>>> cases, std::shared_ptr<Operand> default_label)
+{
+    assert(default_label != nullptr && default_label->type == OperandType::Label);
+    auto quad = std::make_shared<Quad>(QuadOp::Switch, arg1, nullptr, default_label);
+    quad->cases = cases;
+    return quad;
+}
+
 /**
  * Makes an enter quad operation.
  */
@@ -196,6 +228,132 @@ std::shared_ptr<Quad> Quad::MakeCallOp(std::shared_ptr<Operand> func, std::share
     return std::make_shared<Quad>(QuadOp::Call, func, nargs, res);
 }
 
+/********************************************************************************/
+/*                                  Use / Def                                   */
+/********************************************************************************/
+
+/**
+ * Gets the variable operands read by the quad.
+ */
+std::vector<std::shared_ptr<Operand>> Quad::uses()
+{
+    std::vector<std::shared_ptr<Operand>> operands;
+    auto add = [&](std::shared_ptr<Operand> operand)
+    {
+        if (operand != nullptr && operand->type == OperandType::Variable)
+        {
+            operands.push_back(operand);
+        }
+    };
+
+    switch (op)
+    {
+        case QuadOp::Add:
+        case QuadOp::Sub:
+        case QuadOp::Mul:
+        case QuadOp::Div:
+        case QuadOp::Mod:
+        case QuadOp::Eq:
+        case QuadOp::Neq:
+        case QuadOp::Lt:
+        case QuadOp::Leq:
+        case QuadOp::Gt:
+        case QuadOp::Geq:
+        case QuadOp::And:
+        case QuadOp::Or:
+        case QuadOp::BitAnd:
+        case QuadOp::BitOr:
+        case QuadOp::BitXor:
+        case QuadOp::Shl:
+        case QuadOp::Shr:
+        case QuadOp::MulHi:
+        case QuadOp::FAdd:
+        case QuadOp::FSub:
+        case QuadOp::FMul:
+        case QuadOp::FDiv:
+        case QuadOp::AddPtr:
+        case QuadOp::Check:
+        case QuadOp::IfEq:
+        case QuadOp::IfNeq:
+        case QuadOp::IfLt:
+        case QuadOp::IfLeq:
+        case QuadOp::IfGt:
+        case QuadOp::IfGeq:
+            add(arg1);
+            add(arg2);
+            break;
+        case QuadOp::Neg:
+        case QuadOp::FNeg:
+        case QuadOp::Not:
+        case QuadOp::BitNot:
+        case QuadOp::Copy:
+        case QuadOp::Cast:
+        case QuadOp::Splat:
+        case QuadOp::AddrOf:
+        case QuadOp::RDeref:
+        case QuadOp::Switch:
+        case QuadOp::Return:
+        case QuadOp::Param:
+            add(arg1);
+            break;
+        case QuadOp::LDeref:
+            add(arg1);
+            add(res); // the pointer is read, not written
+            break;
+        default:
+            break;
+    }
+
+    return operands;
+}
+
+/**
+ * Gets the variable operand written by the quad, or nullptr if the quad does not write a variable.
+ */
+std::shared_ptr<Operand> Quad::def()
+{
+    switch (op)
+    {
+        case QuadOp::Add:
+        case QuadOp::Sub:
+        case QuadOp::Mul:
+        case QuadOp::Div:
+        case QuadOp::Mod:
+        case QuadOp::Eq:
+        case QuadOp::Neq:
+        case QuadOp::Lt:
+        case QuadOp::Leq:
+        case QuadOp::Gt:
+        case QuadOp::Geq:
+        case QuadOp::And:
+        case QuadOp::Or:
+        case QuadOp::BitAnd:
+        case QuadOp::BitOr:
+        case QuadOp::BitXor:
+        case QuadOp::Shl:
+        case QuadOp::Shr:
+        case QuadOp::MulHi:
+        case QuadOp::FAdd:
+        case QuadOp::FSub:
+        case QuadOp::FMul:
+        case QuadOp::FDiv:
+        case QuadOp::Neg:
+        case QuadOp::FNeg:
+        case QuadOp::Not:
+        case QuadOp::BitNot:
+        case QuadOp::Copy:
+        case QuadOp::Cast:
+        case QuadOp::Splat:
+        case QuadOp::AddrOf:
+        case QuadOp::RDeref:
+        case QuadOp::AddPtr:
+        case QuadOp::Call:
+            return res;
+        default:
+            return nullptr;
+    }
+}
+
 /********************************************************************************/
 /*                                    QuadList                                  */
 /********************************************************************************/
@@ -216,6 +374,42 @@ void QuadList::push_back(std::shared_ptr<Quad> quad)
     }
 }
 
+/**
+ * Inserts a quad into the list after the quad pos.
+ */
+void QuadList::insert_after(std::shared_ptr<Quad> pos, std::shared_ptr<Quad> quad)
+{
+    quad->next = pos->next;
+    pos->next = quad;
+    if (pos == tail)
+    {
+        tail = quad;
+    }
+}
+
+/**
+ * Removes a quad from the list.
+ */
+void QuadList::remove(std::shared_ptr<Quad> quad)
+{
+    if (quad == head)
+    {
+        head = quad->next;
+        tail = tail == quad ? nullptr : tail;
+        return;
+    }
+
+    for (auto prev = head; prev != tail; prev = prev->next)
+    {
+        if (prev->next == quad)
+        {
+            prev->next = quad->next;
+            tail = tail == quad ? prev : tail;
+            return;
+        }
+    }
+}
+
 /**
  * Appends a quad to the list.
  */
@@ -263,6 +457,9 @@ void Operand::dump()
         case OperandType::IntConst:
             std::cerr << iconst;
             break;
+        case OperandType::FloatConst:
+            std::cerr << fconst;
+            break;
         case OperandType::StrConst:
         case OperandType::Label:
             std::cerr << strconst;
@@ -306,6 +503,11 @@ void Quad::dump()
             arg1->dump();
             std::cerr << " - ";
             arg2->dump();
+            if (wraps)
+            {
+                std::cerr << " (wraps)";
+            }
+
             std::cerr << "\n";
             break;
         case QuadOp::Mul:
@@ -332,18 +534,194 @@ void Quad::dump()
             arg2->dump();
             std::cerr << "\n";
             break;
+        case QuadOp::Eq:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " == ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Neq:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " != ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Lt:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " < ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Leq:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " <= ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Gt:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " > ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Geq:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " >= ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::And:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " && ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Or:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " || ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::BitAnd:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " & ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::BitOr:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " | ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::BitXor:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " ^ ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Shl:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " << ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Shr:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " >> ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::MulHi:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " *hi ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::FAdd:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " +. ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::FSub:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " -. ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::FMul:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " *. ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::FDiv:
+            res->dump();
+            std::cerr << " = ";
+            arg1->dump();
+            std::cerr << " /. ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
         case QuadOp::Neg:
             res->dump();
             std::cerr << " = -";
             arg1->dump();
             std::cerr << "\n";
             break;
+        case QuadOp::FNeg:
+            res->dump();
+            std::cerr << " = -.";
+            arg1->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Not:
+            res->dump();
+            std::cerr << " = !";
+            arg1->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::BitNot:
+            res->dump();
+            std::cerr << " = ~";
+            arg1->dump();
+            std::cerr << "\n";
+            break;
         case QuadOp::Copy:
             res->dump();
             std::cerr << " = ";
             arg1->dump();
             std::cerr << "\n";
             break;
+        case QuadOp::Cast:
+            res->dump();
+            std::cerr << " = (";
+            res->symbol->type->dump();
+            std::cerr << ") ";
+            arg1->dump();
+            std::cerr << "\n";
+            break;
+        case QuadOp::Splat:
+            res->dump();
+            std::cerr << " = splat ";
+            arg1->dump();
+            std::cerr << "\n";
+            break;
         // case QuadOp::LIndex:
         //     res->dump();
         //     std::cerr << "[";
@@ -387,9 +765,21 @@ void Quad::dump()
             arg2->dump();
             std::cerr << "\n";
             break;
+        case QuadOp::Check:
+            std::cerr << "check ";
+            arg1->dump();
+            std::cerr << " < ";
+            arg2->dump();
+            std::cerr << "\n";
+            break;
         case QuadOp::Label:
             std::cerr << "label ";
             arg1->dump();
+            if (unroll)
+            {
+                std::cerr << " (unroll " << unroll.value() << ")";
+            }
+
             std::cerr << "\n";
             break;
         case QuadOp::Goto:
@@ -451,6 +841,24 @@ void Quad::dump()
             res->dump();
             std::cerr << "\n";
             break;
+        case QuadOp::Switch:
+            std::cerr << "switch ";
+            arg1->dump();
+            std::cerr << " (";
+            for (auto i = 0; i < cases.size(); i++)
+            {
+                std::cerr << cases[i].first << ": ";
+                cases[i].second->dump();
+                if (i < cases.size() - 1)
+                {
+                    std::cerr << ", ";
+                }
+            }
+
+            std::cerr << ") default ";
+            res->dump();
+            std::cerr << "\n";
+            break;
         case QuadOp::Enter:
             std::cerr << "enter ";
             arg1->dump();
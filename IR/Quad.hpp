@@ -2,6 +2,8 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <optional>
 #include "SymbolTable.hpp"
 
 /** 
@@ -16,14 +18,38 @@ enum class QuadOp
     Mul,
     Div,
     Mod,
+    Eq,     // x = y == z
+    Neq,    // x = y != z
+    Lt,     // x = y < z
+    Leq,    // x = y <= z
+    Gt,     // x = y > z
+    Geq,    // x = y >= z
+    And,    // x = y && z (both operands are evaluated)
+    Or,     // x = y || z (both operands are evaluated)
+    BitAnd, // x = y & z
+    BitOr,  // x = y | z
+    BitXor, // x = y ^ z
+    Shl,    // x = y << z
+    Shr,    // x = y >> z (logical if the type is unsigned, otherwise arithmetic)
+    MulHi,  // x = the high half of the double width product y * z
+    FAdd,   // x = y + z (floating point)
+    FSub,   // x = y - z (floating point)
+    FMul,   // x = y * z (floating point)
+    FDiv,   // x = y / z (floating point)
     Neg,
+    FNeg,   // x = -y (floating point)
+    Not,    // x = !y
+    BitNot, // x = ~y
     Copy,
+    Cast,   // x = (type of x) y
+    Splat,  // x = { y, y, ... } (x is a vector)
     //LIndex, // a[i] = x
     //RIndex, // x = a[i]
     AddrOf, // x = &y
     RDeref, // x = *y
     LDeref, // *x = y
     AddPtr, // x = y + z (y is a pointer variable, z is an integer)
+    Check,  // check 0 <= x < y, trapping if it fails (y is a constant)
     Label,
     Goto,
     IfEq,
@@ -32,6 +58,7 @@ enum class QuadOp
     IfLeq,
     IfGt,
     IfGeq,
+    Switch, // switch x (case c: goto label ...) default goto label
     Enter,
     Return,
     Param,
@@ -44,6 +71,7 @@ enum class QuadOp
 enum class OperandType
 {
     IntConst,
+    FloatConst,
     StrConst,
     Variable,
     Label
@@ -57,16 +85,19 @@ struct Operand
     OperandType type;
 
     long iconst;
+    double fconst;
     std::string strconst;
     std::shared_ptr<Symbol> symbol;
 
     Operand(OperandType type, long val): type(type), iconst(val) {}
+    Operand(OperandType type, double val): type(type), fconst(val) {}
     Operand(OperandType type, std::string val): type(type), strconst(val) {}
     Operand(OperandType type, std::shared_ptr<Symbol> symbol): type(type), symbol(symbol) {}
 
     void dump();
 
     static std::shared_ptr<Operand> MakeIntConstOperand(long val);
+    static std::shared_ptr<Operand> MakeFloatConstOperand(double val);
     static std::shared_ptr<Operand> MakeStrConstOperand(std::string val);
     static std::shared_ptr<Operand> MakeVariableOperand(std::shared_ptr<Symbol> val);
     static std::shared_ptr<Operand> MakeLabelOperand();
@@ -82,9 +113,21 @@ struct Quad
     std::shared_ptr<Operand> arg2;
     std::shared_ptr<Operand> res;
     std::shared_ptr<Quad> next;
+
+    /* for switch quads, the case values and the labels they jump to */
+    std::vector<std::pair<long, std::shared_ptr<Operand>>> cases;
+
+    /* for the label at the top of a loop body, the unroll count requested by #pragma unroll, or 0 to unroll fully */
+    std::optional<int> unroll;
+
+    /* for arithmetic the compiler adds that may overflow on purpose, unlike the arithmetic of the program, where signed overflow is undefined */
+    bool wraps = false;
+
     Quad(QuadOp op, std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> arg2, std::shared_ptr<Operand> res) : op(op), arg1(arg1), arg2(arg2), res(res), next(nullptr) {}
 
     void dump();
+    std::vector<std::shared_ptr<Operand>> uses();
+    std::shared_ptr<Operand> def();
     
     // TODO remove Op suffix
     static std::shared_ptr<Quad> MakeGlobalOp(std::shared_ptr<Operand> arg1);
@@ -97,9 +140,11 @@ struct Quad
     static std::shared_ptr<Quad> MakeRDerefOp(std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> res);
     static std::shared_ptr<Quad> MakeLDerefOp(std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> res);
     static std::shared_ptr<Quad> MakeAddPtrOp(std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> arg2, std::shared_ptr<Operand> res);
+    static std::shared_ptr<Quad> MakeCheckOp(std::shared_ptr<Operand> index, std::shared_ptr<Operand> size);
     static std::shared_ptr<Quad> MakeLabelOp(std::shared_ptr<Operand> label);
     static std::shared_ptr<Quad> MakeGotoOp(std::shared_ptr<Operand> label);
     static std::shared_ptr<Quad> MakeIfOp(QuadOp op, std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> arg2, std::shared_ptr<Operand> res);
+    static std::shared_ptr<Quad> MakeSwitchOp(std::shared_ptr<Operand> arg1, std::vector<std::pair<long, std::shared_ptr<Operand>>> cases, std::shared_ptr<Operand> default_label);
     static std::shared_ptr<Quad> MakeEnterOp(std::shared_ptr<Operand> func);
     static std::shared_ptr<Quad> MakeReturnOp(std::shared_ptr<Operand> arg1);
     static std::shared_ptr<Quad> MakeReturnOp();
@@ -128,6 +173,9 @@ public:
     inline std::shared_ptr<Quad> end() { return tail != nullptr ? tail->next : nullptr; }
     void dump();
 
+    void insert_after(std::shared_ptr<Quad> pos, std::shared_ptr<Quad> quad);
+    void remove(std::shared_ptr<Quad> quad);
+
     static QuadList append(QuadList& list, std::shared_ptr<Quad> quad);
     static QuadList concat(QuadList& list1, QuadList& list2);
 };
\ No newline at end of file
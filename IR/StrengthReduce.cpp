@@ -0,0 +1,386 @@
+#include <map>
+#include <utility>
+#include <cassert>
+#include "StrengthReduce.hpp"
+
+/**
+ * Emits the quads that replace a multiply, divide, or modulo by a constant. New quads are inserted before the
+ * quad being replaced, which becomes the last quad of the sequence so that it still defines the same result.
+ */
+class Rewriter
+{
+private:
+    std::shared_ptr<Quad> prev;
+    std::shared_ptr<Quad> quad;
+    QuadList& qlist;
+    std::shared_ptr<SymbolTable> symbol_table;
+
+public:
+    Rewriter(std::shared_ptr<Quad> prev, std::shared_ptr<Quad> quad, QuadList& qlist, std::shared_ptr<SymbolTable> symbol_table) :
+        prev(prev), quad(quad), qlist(qlist), symbol_table(symbol_table) {}
+
+    /**
+     * Emits a binary quad into a new temp and returns the temp.
+     */
+    std::shared_ptr<Operand> emit(QuadOp op, std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> arg2)
+    {
+        auto temp = Operand::MakeVariableOperand(symbol_table->new_temp(quad->res->symbol->type));
+        auto inst = Quad::MakeBinOp(op, arg1, arg2, temp);
+        qlist.insert_after(prev, inst);
+        prev = inst;
+        return temp;
+    }
+
+    /**
+     * Turns the quad being replaced into the final quad of the sequence. If wraps is set, the final quad may overflow
+     * even though the original did not.
+     */
+    void finish(QuadOp op, std::shared_ptr<Operand> arg1, std::shared_ptr<Operand> arg2 = nullptr, bool wraps = false)
+    {
+        quad->op = op;
+        quad->arg1 = arg1;
+        quad->arg2 = arg2;
+        quad->wraps = wraps;
+    }
+};
+
+/**
+ * Gets the width in bits of the integer type that the strength reductions are applied to, or 0 if they do not apply.
+ */
+static int get_width(std::shared_ptr<Type> type)
+{
+    return type->type == TypeType::Int || type->type == TypeType::Long ? type->size() * 8 : 0;
+}
+
+/**
+ * Determines if the constant is representable as a signed integer of the given width.
+ */
+static bool fits(long value, int width)
+{
+    return width == 64 || (value >= -(1L << (width - 1)) && value < (1L << (width - 1)));
+}
+
+/**
+ * Gets k if the value is 2^k with k >= 1, otherwise returns -1.
+ */
+static int log2_exact(unsigned long value)
+{
+    if (value < 2 || (value & (value - 1)) != 0)
+    {
+        return -1;
+    }
+
+    return __builtin_ctzl(value);
+}
+
+/**
+ * Computes the magic number M and shift s for signed division by the constant d, so that
+ * n / d = (mulhi(n, M) [+ or - n]) >> s, rounded towards zero. From Hacker's Delight, figure 10-1.
+ */
+static std::pair<long, int> signed_magic(long d, int width)
+{
+    unsigned long mask = width == 64 ? ~0UL : (1UL << width) - 1;
+    unsigned long two = 1UL << (width - 1);
+    unsigned long ad = (d < 0 ? -(unsigned long)d : (unsigned long)d) & mask;
+    unsigned long t = two + (d < 0 ? 1 : 0);
+    unsigned long anc = t - 1 - t % ad;
+    int p = width - 1;
+    unsigned long q1 = two / anc;
+    unsigned long r1 = two - q1 * anc;
+    unsigned long q2 = two / ad;
+    unsigned long r2 = two - q2 * ad;
+    unsigned long delta;
+    do
+    {
+        p++;
+        q1 = (q1 * 2) & mask;
+        r1 = (r1 * 2) & mask;
+        if (r1 >= anc)
+        {
+            q1 = (q1 + 1) & mask;
+            r1 = (r1 - anc) & mask;
+        }
+
+        q2 = (q2 * 2) & mask;
+        r2 = (r2 * 2) & mask;
+        if (r2 >= ad)
+        {
+            q2 = (q2 + 1) & mask;
+            r2 = (r2 - ad) & mask;
+        }
+
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    unsigned long magic = (q2 + 1) & mask;
+    if (d < 0)
+    {
+        magic = (-magic) & mask;
+    }
+
+    // sign extend the magic number from the width of the type
+    long signed_magic = (magic & two) ? (long)(magic | ~mask) : (long)magic;
+    return { signed_magic, p - width };
+}
+
+/**
+ * Emits x + (2^k - 1 if x is negative, otherwise 0), which biases x so that an arithmetic shift or mask rounds towards zero.
+ */
+static std::shared_ptr<Operand> emit_round_bias(Rewriter& rewriter, std::shared_ptr<Operand> x, int k, int width)
+{
+    auto sign = rewriter.emit(QuadOp::Shr, x, Operand::MakeIntConstOperand(width - 1));
+    auto bias = rewriter.emit(QuadOp::BitAnd, sign, Operand::MakeIntConstOperand((long)((1UL << k) - 1)));
+    return rewriter.emit(QuadOp::Add, x, bias);
+}
+
+/**
+ * Emits the quotient x / d for a constant d that is not 0, 1, -1, or a power of two, using a magic number multiply.
+ */
+static std::shared_ptr<Operand> emit_magic_quotient(Rewriter& rewriter, std::shared_ptr<Operand> x, long d, int width)
+{
+    auto [magic, shift] = signed_magic(d, width);
+    auto q = rewriter.emit(QuadOp::MulHi, x, Operand::MakeIntConstOperand(magic));
+    if (d > 0 && magic < 0)
+    {
+        q = rewriter.emit(QuadOp::Add, q, x);
+    }
+    else if (d < 0 && magic > 0)
+    {
+        q = rewriter.emit(QuadOp::Sub, q, x);
+    }
+
+    if (shift > 0)
+    {
+        q = rewriter.emit(QuadOp::Shr, q, Operand::MakeIntConstOperand(shift));
+    }
+
+    // add one if the quotient is negative, to round towards zero
+    auto sign = rewriter.emit(QuadOp::Shr, q, Operand::MakeIntConstOperand(width - 1));
+    return rewriter.emit(QuadOp::Sub, q, sign);
+}
+
+/**
+ * Rewrites x * c.
+ */
+static void reduce_mul(Rewriter& rewriter, std::shared_ptr<Operand> x, long c)
+{
+    int k = log2_exact(c < 0 ? -(unsigned long)c : c);
+    if (c == 0)
+    {
+        rewriter.finish(QuadOp::Copy, Operand::MakeIntConstOperand(0));
+    }
+    else if (c == 1)
+    {
+        rewriter.finish(QuadOp::Copy, x);
+    }
+    else if (c == -1)
+    {
+        rewriter.finish(QuadOp::Neg, x);
+    }
+    else if (k > 0 && c > 0)
+    {
+        rewriter.finish(QuadOp::Shl, x, Operand::MakeIntConstOperand(k));
+    }
+    else if (k > 0)
+    {
+        // x * -2^k does not overflow when x = 2^(width-1-k), but x << k is then the minimum value, and negating it wraps
+        auto shifted = rewriter.emit(QuadOp::Shl, x, Operand::MakeIntConstOperand(k));
+        rewriter.finish(QuadOp::Neg, shifted, nullptr, true);
+    }
+}
+
+/**
+ * Rewrites x / c.
+ */
+static void reduce_div(Rewriter& rewriter, std::shared_ptr<Operand> x, long c, int width)
+{
+    int k = log2_exact(c < 0 ? -(unsigned long)c : c);
+    if (c == 0)
+    {
+        return; // leave the division by zero to trap at runtime
+    }
+    else if (c == 1)
+    {
+        rewriter.finish(QuadOp::Copy, x);
+    }
+    else if (c == -1)
+    {
+        rewriter.finish(QuadOp::Neg, x);
+    }
+    else if (k > 0)
+    {
+        auto biased = emit_round_bias(rewriter, x, k, width);
+        if (c > 0)
+        {
+            rewriter.finish(QuadOp::Shr, biased, Operand::MakeIntConstOperand(k));
+        }
+        else
+        {
+            auto q = rewriter.emit(QuadOp::Shr, biased, Operand::MakeIntConstOperand(k));
+            rewriter.finish(QuadOp::Neg, q);
+        }
+    }
+    else
+    {
+        auto q = emit_magic_quotient(rewriter, x, c, width);
+        rewriter.finish(QuadOp::Copy, q);
+    }
+}
+
+/**
+ * Rewrites x % c.
+ */
+static void reduce_mod(Rewriter& rewriter, std::shared_ptr<Operand> x, long c, int width)
+{
+    // the sign of the remainder follows x, so only the magnitude of c matters
+    int k = log2_exact(c < 0 ? -(unsigned long)c : c);
+    if (c == 0)
+    {
+        return; // leave the division by zero to trap at runtime
+    }
+    else if (c == 1 || c == -1)
+    {
+        rewriter.finish(QuadOp::Copy, Operand::MakeIntConstOperand(0));
+    }
+    else if (k > 0)
+    {
+        auto biased = emit_round_bias(rewriter, x, k, width);
+        auto multiple = rewriter.emit(QuadOp::BitAnd, biased, Operand::MakeIntConstOperand((long)(~0UL << k)));
+        rewriter.finish(QuadOp::Sub, x, multiple);
+    }
+    else
+    {
+        auto q = emit_magic_quotient(rewriter, x, c, width);
+        auto multiple = rewriter.emit(QuadOp::Mul, q, Operand::MakeIntConstOperand(c));
+        rewriter.finish(QuadOp::Sub, x, multiple);
+    }
+}
+
+/**
+ * Rewrites x / c for unsigned x.
+ */
+static void reduce_udiv(Rewriter& rewriter, std::shared_ptr<Operand> x, long c)
+{
+    int k = log2_exact(c);
+    if (c == 1)
+    {
+        rewriter.finish(QuadOp::Copy, x);
+    }
+    else if (k > 0)
+    {
+        rewriter.finish(QuadOp::Shr, x, Operand::MakeIntConstOperand(k));
+    }
+}
+
+/**
+ * Rewrites x % c for unsigned x.
+ */
+static void reduce_umod(Rewriter& rewriter, std::shared_ptr<Operand> x, long c)
+{
+    int k = log2_exact(c);
+    if (c == 1)
+    {
+        rewriter.finish(QuadOp::Copy, Operand::MakeIntConstOperand(0));
+    }
+    else if (k > 0)
+    {
+        rewriter.finish(QuadOp::BitAnd, x, Operand::MakeIntConstOperand(c - 1));
+    }
+}
+
+/**
+ * Replaces variable operands with the constant that was copied into them, if known.
+ */
+static std::shared_ptr<Operand> forward_constant(std::shared_ptr<Operand> operand, std::map<Symbol *, long>& constants)
+{
+    if (operand->type == OperandType::Variable)
+    {
+        auto it = constants.find(operand->symbol.get());
+        if (it != constants.end())
+        {
+            return Operand::MakeIntConstOperand(it->second);
+        }
+    }
+
+    return operand;
+}
+
+/**
+ * Rewrites integer multiplies, divides, and modulos by constants into shifts, masks, and magic number multiplies.
+ * Unsigned divides and modulos are only rewritten for powers of two.
+ * Constants are forwarded from the temps they were copied into within each block, since the IR for an
+ * expression like x / 8 first copies 8 into a temp.
+ */
+void StrengthReduce(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table)
+{
+    for (auto& block : cfg)
+    {
+        std::map<Symbol *, long> constants;
+        std::shared_ptr<Quad> prev = nullptr;
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            bool is_arith = quad->op == QuadOp::Mul || quad->op == QuadOp::Div || quad->op == QuadOp::Mod;
+            int width = quad->def() != nullptr ? get_width(quad->res->symbol->type) : 0;
+            bool is_unsigned = width > 0 && quad->res->symbol->type->is_unsigned;
+            if (is_arith && width > 0 && prev != nullptr)
+            {
+                auto arg1 = forward_constant(quad->arg1, constants);
+                auto arg2 = forward_constant(quad->arg2, constants);
+                if (quad->op == QuadOp::Mul && arg1->type == OperandType::IntConst)
+                {
+                    std::swap(arg1, arg2);
+                }
+
+                // if both are constants, the LLVM IR builder folds them anyway
+                if (arg1->type == OperandType::Variable && arg2->type == OperandType::IntConst && fits(arg2->iconst, width))
+                {
+                    Rewriter rewriter(prev, quad, block->qlist, symbol_table);
+                    switch (quad->op)
+                    {
+                        case QuadOp::Mul:
+                            reduce_mul(rewriter, arg1, arg2->iconst);
+                            break;
+                        case QuadOp::Div:
+                            if (!is_unsigned)
+                            {
+                                reduce_div(rewriter, arg1, arg2->iconst, width);
+                            }
+                            else if (arg2->iconst > 0)
+                            {
+                                reduce_udiv(rewriter, arg1, arg2->iconst);
+                            }
+
+                            break;
+                        case QuadOp::Mod:
+                            if (!is_unsigned)
+                            {
+                                reduce_mod(rewriter, arg1, arg2->iconst, width);
+                            }
+                            else if (arg2->iconst > 0)
+                            {
+                                reduce_umod(rewriter, arg1, arg2->iconst);
+                            }
+
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+
+            auto res = quad->def();
+            if (res != nullptr)
+            {
+                // negative constants are the negation of a positive constant
+                auto arg1 = quad->arg1 != nullptr ? forward_constant(quad->arg1, constants) : nullptr;
+                constants.erase(res->symbol.get());
+                if ((quad->op == QuadOp::Copy || quad->op == QuadOp::Neg) && arg1 != nullptr && arg1->type == OperandType::IntConst && res->symbol->is_temp)
+                {
+                    constants[res->symbol.get()] = quad->op == QuadOp::Neg ? -arg1->iconst : arg1->iconst;
+                }
+            }
+
+            prev = quad;
+        }
+    }
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "CFG.hpp"
+
+void StrengthReduce(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table);
@@ -0,0 +1,138 @@
+#include <map>
+#include <algorithm>
+#include "Loop.hpp"
+#include "Unroll.hpp"
+
+// the most quads that -funroll-loops, or #pragma unroll without a count, will grow a loop body to when it fully unrolls it
+const int full_unroll_size = 256;
+const int pragma_full_unroll_size = 4096;
+
+/**
+ * Gets the operand with its temp replaced by the temp of the current copy of the body, if it has one.
+ */
+static std::shared_ptr<Operand> rename(std::shared_ptr<Operand> operand, std::map<Symbol *, std::shared_ptr<Symbol>>& temps)
+{
+    if (operand == nullptr || operand->type != OperandType::Variable || temps.find(operand->symbol.get()) == temps.end())
+    {
+        return operand;
+    }
+
+    return Operand::MakeVariableOperand(temps[operand->symbol.get()]);
+}
+
+/**
+ * Copies the body of the loop, including the update of the induction variable, the given number of times.
+ * The temps defined in the body are given new temps in each copy, so each temp is still written once.
+ */
+static std::vector<std::shared_ptr<Quad>> copy_body(Loop& loop, int copies, std::shared_ptr<SymbolTable> symbol_table)
+{
+    std::vector<std::shared_ptr<Quad>> body;
+    for (auto i = 0; i < copies; i++)
+    {
+        std::map<Symbol *, std::shared_ptr<Symbol>> temps;
+        for (auto quad = loop.body->qlist.get_head()->next; quad != loop.body->qlist.end(); quad = quad->next)
+        {
+            auto copy = std::make_shared<Quad>(*quad);
+            copy->next = nullptr;
+            copy->arg1 = rename(quad->arg1, temps);
+            copy->arg2 = rename(quad->arg2, temps);
+
+            auto def = quad->def();
+            if (def != nullptr && def->symbol->is_temp)
+            {
+                temps[def->symbol.get()] = symbol_table->new_temp(def->symbol->type);
+            }
+
+            copy->res = rename(quad->res, temps);
+            body.push_back(copy);
+        }
+    }
+
+    return body;
+}
+
+/**
+ * Chooses how many copies of the body to make for the loop. #pragma unroll(N) asks for N copies, and #pragma unroll
+ * or -funroll-loops ask for the loop to be fully unrolled if the trip count is known, otherwise for -funroll-count copies.
+ * Returns 0 with the reason set if the loop should not be unrolled.
+ */
+static int choose_factor(Loop& loop, const Options& options, std::string& reason)
+{
+    auto hint = loop.body->qlist.get_head()->unroll;
+    auto body_size = count_quads(loop.body) - 1;
+    auto trip_count = loop.trip_count();
+
+    auto factor = hint && hint.value() > 0 ? hint.value() : options.unroll_count;
+    if (trip_count)
+    {
+        // fully unrolling a loop replaces its back edge with one check before and after the copies
+        auto max_size = hint ? pragma_full_unroll_size : full_unroll_size;
+        if ((!hint || hint.value() == 0) && trip_count.value() * body_size <= max_size)
+        {
+            factor = trip_count.value();
+        }
+
+        factor = std::min(factor, (int)trip_count.value());
+    }
+
+    if (factor < 2)
+    {
+        reason = "loop runs fewer than 2 iterations";
+        return 0;
+    }
+    else if (loop.bound->type == OperandType::IntConst && loop.bound->iconst - (factor - 1) * loop.step < loop.induction->type->min_value())
+    {
+        // the limit of the unrolled loop would not fit the type of the induction variable, and would wrap around
+        reason = "loop bound is too small to unroll by " + std::to_string(factor);
+        return 0;
+    }
+
+    return factor;
+}
+
+/**
+ * Unrolls the counted loops of a function that are marked with #pragma unroll, or all of them with -funroll-loops.
+ * An unrolled copy of the loop is inserted before it, and the loop is left in place as the remainder loop.
+ * Returns true if any loop was unrolled, in which case the quads have changed and the CFG must be constructed again.
+ */
+bool UnrollLoops(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table, const std::string& function_name, const Options& options)
+{
+    auto size_before = count_quads(cfg);
+    bool changed = false;
+    for (auto& loop : FindLoops(cfg))
+    {
+        auto hint = loop.body->qlist.get_head()->unroll;
+        if ((!hint && !options.unroll_loops) || hint == 1)
+        {
+            continue;
+        }
+        else if (!loop.is_counted)
+        {
+            options.remark("unroll", function_name, loop.name() + ": loop not unrolled: " + loop.reason);
+            continue;
+        }
+
+        std::string reason;
+        auto factor = choose_factor(loop, options, reason);
+        if (factor == 0)
+        {
+            options.remark("unroll", function_name, loop.name() + ": loop not unrolled: " + reason);
+            continue;
+        }
+
+        std::vector<std::shared_ptr<Quad>> setup;
+        auto body = copy_body(loop, factor, symbol_table);
+        loop.insert_before(setup, body, factor, symbol_table);
+        changed = true;
+
+        auto full = loop.trip_count() == factor;
+        options.remark("unroll", function_name, loop.name() + ": " + (full ? "fully unrolled loop" : "unrolled loop") + " by a factor of " + std::to_string(factor) + " (" + std::to_string(body.size()) + " quads in the unrolled body)");
+    }
+
+    if (changed)
+    {
+        options.remark("unroll", function_name, "code size grew from " + std::to_string(size_before) + " to " + std::to_string(count_quads(cfg)) + " quads");
+    }
+
+    return changed;
+}
@@ -0,0 +1,395 @@
+#include <map>
+#include <set>
+#include "Loop.hpp"
+#include "Vectorize.hpp"
+
+// the width in bytes of the vectors that loops are vectorized to, i.e. the SSE2 and NEON registers
+const int vector_width = 16;
+
+/**
+ * Rewrites a counted loop into a vector loop that runs before it. Each iteration of the vector loop does the work
+ * of several iterations of the original loop, which is left in place to run the remaining iterations.
+ *
+ * A loop is vectorized when every array access is indexed by the induction variable, so the iterations are
+ * independent, and every array is a distinct local or global array, so the accesses cannot overlap.
+ */
+class LoopVectorizer
+{
+private:
+    Loop& loop;
+    std::shared_ptr<SymbolTable> symbol_table;
+    std::set<Symbol *>& used_temps;
+
+    std::shared_ptr<Type> elem_type;
+    std::shared_ptr<Type> vector_type;
+
+    /* the address temps of the loop body mapped to their copies in the vector body */
+    std::map<Symbol *, std::shared_ptr<Operand>> addresses;
+
+    /* the value temps of the loop body mapped to the vectors that replace them */
+    std::map<Symbol *, std::shared_ptr<Operand>> values;
+
+    /* the loop invariant variables that have been splatted, mapped to their vectors */
+    std::map<Symbol *, std::shared_ptr<Operand>> invariants;
+
+    /* the quads that run once before the vector loop, and the quads of the vector body */
+    std::vector<std::shared_ptr<Quad>> splats;
+    std::vector<std::shared_ptr<Quad>> body;
+
+    std::shared_ptr<Operand> new_vector()
+    {
+        return Operand::MakeVariableOperand(symbol_table->new_temp(vector_type));
+    }
+
+    /**
+     * Creates a vector with every element set to the operand, before the vector loop.
+     */
+    std::shared_ptr<Operand> splat(std::shared_ptr<Operand> operand)
+    {
+        auto vector = new_vector();
+        splats.push_back(Quad::MakeUnOp(QuadOp::Splat, operand, vector));
+        return vector;
+    }
+
+    /**
+     * Gets the vector that replaces an operand of the loop body, or nullptr with the reason set if there is none.
+     */
+    std::shared_ptr<Operand> get_vector(std::shared_ptr<Operand> operand)
+    {
+        if (operand->type == OperandType::IntConst || operand->type == OperandType::FloatConst)
+        {
+            return splat(operand);
+        }
+
+        auto symbol = operand->symbol;
+        if (symbol->is_temp)
+        {
+            if (values.find(symbol.get()) == values.end())
+            {
+                reason = "loop uses a value computed outside of it";
+                return nullptr;
+            }
+
+            return values[symbol.get()];
+        }
+        else if (symbol == loop.induction)
+        {
+            reason = "induction variable is used as a value";
+            return nullptr;
+        }
+        else if (*symbol->type != *elem_type)
+        {
+            reason = "loop mixes element types";
+            return nullptr;
+        }
+
+        // the loop writes no variables except the induction variable, so every other variable is invariant
+        if (invariants.find(symbol.get()) == invariants.end())
+        {
+            invariants[symbol.get()] = splat(operand);
+        }
+
+        return invariants[symbol.get()];
+    }
+
+    /**
+     * Checks that a value temp of the loop body has the element type.
+     */
+    bool check_value(std::shared_ptr<Operand> res)
+    {
+        if (!res->symbol->is_temp)
+        {
+            reason = "loop writes " + res->symbol->get_source_name() + " in every iteration";
+            return false;
+        }
+        else if (*res->symbol->type != *elem_type)
+        {
+            reason = "loop mixes element types";
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Finds the element type of the arrays that the loop accesses, which sets the number of lanes in the vectors.
+     */
+    bool find_elem_type()
+    {
+        for (auto quad = loop.body->qlist.begin(); quad != loop.body->qlist.end(); quad = quad->next)
+        {
+            if (quad->op != QuadOp::AddPtr)
+            {
+                continue;
+            }
+
+            auto type = quad->res->symbol->type->elem_type;
+            if (elem_type == nullptr)
+            {
+                elem_type = type;
+            }
+            else if (*elem_type != *type)
+            {
+                reason = "loop mixes element types";
+                return false;
+            }
+        }
+
+        if (elem_type == nullptr)
+        {
+            reason = "loop does not access any arrays";
+            return false;
+        }
+        else if (!elem_type->is_arithmetic())
+        {
+            reason = "loop accesses arrays of non-arithmetic elements";
+            return false;
+        }
+
+        vector_type = std::make_shared<Type>(TypeType::Vector, elem_type, vector_width / elem_type->size());
+        vector_type->is_unsigned = elem_type->is_unsigned;
+        return true;
+    }
+
+    /**
+     * Translates a quad of the loop body into the vector body.
+     */
+    bool translate(std::shared_ptr<Quad> quad)
+    {
+        switch (quad->op)
+        {
+            case QuadOp::Label:
+                return true;
+            case QuadOp::AddPtr:
+            {
+                auto array = quad->arg1->symbol;
+                // array parameters are pointers, even when they are declared with a size, and only restrict ones are known not to alias
+                auto is_array = array->type->type == TypeType::Array && array->type->num_elems && !array->is_parameter;
+                auto is_restrict = array->type->type == TypeType::Pointer && array->type->is_restrict;
+                if (!is_array && !is_restrict)
+                {
+                    reason = array->get_source_name() + " may alias another array";
+                    return false;
+                }
+                else if (quad->arg2->type != OperandType::Variable || quad->arg2->symbol != loop.induction)
+                {
+                    reason = "array index is not the induction variable";
+                    return false;
+                }
+
+                auto address = Operand::MakeVariableOperand(symbol_table->new_temp(quad->res->symbol->type));
+                body.push_back(Quad::MakeAddPtrOp(quad->arg1, quad->arg2, address));
+                addresses[quad->res->symbol.get()] = address;
+                return true;
+            }
+            case QuadOp::RDeref:
+            {
+                if (addresses.find(quad->arg1->symbol.get()) == addresses.end())
+                {
+                    reason = "loop loads through a pointer";
+                    return false;
+                }
+                else if (!check_value(quad->res))
+                {
+                    return false;
+                }
+
+                auto vector = new_vector();
+                body.push_back(Quad::MakeRDerefOp(addresses[quad->arg1->symbol.get()], vector));
+                values[quad->res->symbol.get()] = vector;
+                return true;
+            }
+            case QuadOp::LDeref:
+            {
+                if (addresses.find(quad->res->symbol.get()) == addresses.end())
+                {
+                    reason = "loop stores through a pointer";
+                    return false;
+                }
+
+                auto vector = get_vector(quad->arg1);
+                if (vector == nullptr)
+                {
+                    return false;
+                }
+
+                body.push_back(Quad::MakeLDerefOp(vector, addresses[quad->res->symbol.get()]));
+                return true;
+            }
+            case QuadOp::Add:
+            case QuadOp::Sub:
+            case QuadOp::Mul:
+            case QuadOp::BitAnd:
+            case QuadOp::BitOr:
+            case QuadOp::BitXor:
+            case QuadOp::Shl:
+            case QuadOp::Shr:
+            case QuadOp::FAdd:
+            case QuadOp::FSub:
+            case QuadOp::FMul:
+            case QuadOp::FDiv:
+            {
+                if (!check_value(quad->res))
+                {
+                    return false;
+                }
+
+                auto arg1 = get_vector(quad->arg1);
+                auto arg2 = arg1 != nullptr ? get_vector(quad->arg2) : nullptr;
+                if (arg2 == nullptr)
+                {
+                    return false;
+                }
+
+                auto vector = new_vector();
+                body.push_back(Quad::MakeBinOp(quad->op, arg1, arg2, vector));
+                values[quad->res->symbol.get()] = vector;
+                return true;
+            }
+            case QuadOp::Neg:
+            case QuadOp::FNeg:
+            case QuadOp::BitNot:
+            {
+                if (!check_value(quad->res))
+                {
+                    return false;
+                }
+
+                auto arg1 = get_vector(quad->arg1);
+                if (arg1 == nullptr)
+                {
+                    return false;
+                }
+
+                auto vector = new_vector();
+                body.push_back(Quad::MakeUnOp(quad->op, arg1, vector));
+                values[quad->res->symbol.get()] = vector;
+                return true;
+            }
+            case QuadOp::Copy:
+            {
+                if (quad->res->symbol->is_temp && used_temps.find(quad->res->symbol.get()) == used_temps.end())
+                {
+                    // e.g. the value of a postfix increment that is never used
+                    return true;
+                }
+                else if (!check_value(quad->res))
+                {
+                    return false;
+                }
+
+                auto arg1 = get_vector(quad->arg1);
+                if (arg1 == nullptr)
+                {
+                    return false;
+                }
+
+                values[quad->res->symbol.get()] = arg1;
+                return true;
+            }
+            case QuadOp::Param:
+            case QuadOp::Call:
+                reason = "loop contains a call";
+                return false;
+            default:
+                reason = "loop contains an operation that cannot be vectorized";
+                return false;
+        }
+    }
+
+public:
+    std::string reason;
+
+    LoopVectorizer(Loop& loop, std::shared_ptr<SymbolTable> symbol_table, std::set<Symbol *>& used_temps) :
+        loop(loop), symbol_table(symbol_table), used_temps(used_temps) {}
+
+    int get_width() { return vector_type->num_elems.value(); }
+
+    /**
+     * Translates the loop body into the vector body. Returns false with the reason set if the loop cannot be vectorized.
+     */
+    bool translate()
+    {
+        if (loop.step != 1)
+        {
+            reason = "induction variable is not increased by 1";
+            return false;
+        }
+        else if (!find_elem_type())
+        {
+            return false;
+        }
+
+        // the vector loop runs while a whole vector of iterations remains, so the bound must leave room for one
+        if (loop.bound->type == OperandType::IntConst && loop.bound->iconst < get_width())
+        {
+            reason = "loop runs too few iterations";
+            return false;
+        }
+
+        for (auto quad = loop.body->qlist.begin(); quad != loop.body->qlist.end(); quad = quad->next)
+        {
+            if (loop.update.find(quad.get()) == loop.update.end() && !translate(quad))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Inserts the vector loop before the loop, which is left to finish the iterations that are left.
+     * The scalar loop runs fewer iterations than the width, so it is not worth unrolling.
+     */
+    void emit()
+    {
+        auto induction = Operand::MakeVariableOperand(loop.induction);
+        body.push_back(Quad::MakeBinOp(QuadOp::Add, induction, Operand::MakeIntConstOperand(get_width()), induction));
+        loop.insert_before(splats, body, get_width(), symbol_table);
+        loop.body->qlist.get_head()->unroll = 1;
+    }
+};
+
+/**
+ * Vectorizes the counted loops of a function. Returns true if any loop was vectorized, in which case
+ * the quads have changed and the CFG must be constructed again.
+ */
+bool VectorizeLoops(std::vector<std::shared_ptr<BasicBlock>>& cfg, std::shared_ptr<SymbolTable> symbol_table, const std::string& function_name, const Options& options)
+{
+    // copies into temps that are never used can be dropped from the vector body
+    std::set<Symbol *> used_temps;
+    for (auto& block : cfg)
+    {
+        for (auto quad = block->qlist.begin(); quad != block->qlist.end(); quad = quad->next)
+        {
+            for (auto& operand : quad->uses())
+            {
+                used_temps.insert(operand->symbol.get());
+            }
+        }
+    }
+
+    bool changed = false;
+    for (auto& loop : FindLoops(cfg))
+    {
+        if (!loop.is_counted)
+        {
+            options.remark("vectorize", function_name, loop.name() + ": loop not vectorized: " + loop.reason);
+            continue;
+        }
+
+        LoopVectorizer vectorizer(loop, symbol_table, used_temps);
+        if (!vectorizer.translate())
+        {
+            options.remark("vectorize", function_name, loop.name() + ": loop not vectorized: " + vectorizer.reason);
+            continue;
+        }
+
+        vectorizer.emit();
+        changed = true;
+        options.remark("vectorize", function_name, loop.name() + ": vectorized loop (vectorization width: " + std::to_string(vectorizer.get_width()) + ")");
+    }
+
+    return changed;
+}
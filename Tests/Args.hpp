@@ -1,23 +1,28 @@
 #pragma once
 
 
+#include <thread>
+#include <algorithm>
 #include <tclap/CmdLine.h>
 
 struct Args
 {
     std::string output;
     std::string test;
-
+    int jobs;
 
     Args(int argc, char *argv[])
     {
         TCLAP::CmdLine cmd("Test Alexander's C Compiler", ' ', "1.0");
         TCLAP::ValueArg<std::string> output_arg("o", "output", "Specify the output file", false, "", "string", cmd);
         TCLAP::ValueArg<std::string> test_arg("t", "test", "Specify a test to run", false, "", "string", cmd);
+        TCLAP::ValueArg<int> jobs_arg("j", "jobs", "The number of inputs to build and run at once, by default one per core", false, std::max(1u, std::thread::hardware_concurrency()), "int", cmd);
 
         cmd.parse(argc, argv);
 
         output = output_arg.getValue();
         test = test_arg.getValue();
+        // at least one worker is needed to build and run the inputs
+        jobs = std::max(1, jobs_arg.getValue());
     }
 };
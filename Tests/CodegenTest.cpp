@@ -1,61 +1,442 @@
 #include <iostream>
 #include <vector>
+#include <map>
+#include <tuple>
+#include <set>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <filesystem>
 #include <stdlib.h>
+#include <sys/wait.h>
 #include <gtest/gtest.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Operator.h>
+#include <llvm/Support/raw_ostream.h>
 #include "TestUtils.hpp"
 #include "Environment.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
 #include "Codegen.hpp"
+#include "LTO.hpp"
+#include "Options.hpp"
 
-static void execute(int test_id, std::string cmd, bool check_status = true)
+// the test runtime is the same for every input, so clang builds it once
+static const std::string runtime_filepath = "Tests/out/test-code.o";
+
+/**
+ * The options that every input is compiled with, each of which must give the same output as clang.
+ */
+struct Config
+{
+    std::string name;
+    Options options;
+
+    // link time optimize the module, as -flto does
+    bool lto = false;
+};
+
+static std::vector<Config> get_configs()
+{
+    std::vector<Config> configs(7);
+    configs[0].name = "default";
+    configs[1].name = "unroll_loops";
+    configs[1].options.unroll_loops = true;
+    configs[2].name = "bounds_check";
+    configs[2].options.bounds_check = true;
+    configs[3].name = "whole_program";
+    configs[3].options.whole_program = true;
+    configs[4].name = "fast_math";
+    configs[4].options.fast_math = true;
+    configs[5].name = "no_vectorize";
+    configs[5].options.vectorize = false;
+    configs[6].name = "lto";
+    configs[6].lto = true;
+    return configs;
+}
+
+static const std::vector<Config> configs = get_configs();
+
+/**
+ * The output and exit status of an input compiled by acc and by clang, or the error if one of them failed to build.
+ */
+struct CodegenResult
+{
+    std::string error;
+    std::string output;
+    std::string ref_output;
+};
+
+/**
+ * An input waiting for a worker to build and run it, with the LLVM code generated for each config.
+ */
+struct Job
+{
+    Input input;
+    OutputFiles ref_files;
+    std::vector<OutputFiles> output_files;
+    std::vector<std::string> errors;
+    std::vector<std::promise<CodegenResult>> results;
+};
+
+void PrintTo(const Input& input, std::ostream *os)
+{
+    *os << input.filepath;
+}
+
+void PrintTo(const Config& config, std::ostream *os)
+{
+    *os << config.name;
+}
+
+/**
+ * Runs the command and returns its exit status.
+ */
+static int execute(const std::string& cmd)
 {
     auto ec = system(cmd.c_str());
-    if (check_status)
-    {
-        EXPECT_EQ(ec, 0) << "command: " << cmd << " failed to execute for test " << test_id;
-    }
+    return WIFEXITED(ec) ? WEXITSTATUS(ec) : -1;
+}
+
+static std::string read_file(const std::string& filepath)
+{
+    std::ifstream file(filepath);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
 }
 
-TEST(Codegen, All)
+/**
+ * Runs the executable and returns what it printed followed by its exit status.
+ */
+static std::string run(const std::string& exe_filepath, const std::string& out_filepath)
 {
-    for (auto& input : all_inputs)
+    auto status = execute("./" + exe_filepath + " > " + out_filepath);
+    return read_file(out_filepath) + "exit status: " + std::to_string(status) + "\n";
+}
+
+/**
+ * Gets the output files of the input compiled with the config, in a directory of their own.
+ */
+static OutputFiles get_output_files(const Input& input, const Config& config)
+{
+    auto outdir = "Tests/out/test" + std::to_string(input.test_id) + "/" + config.name;
+    std::filesystem::create_directories(outdir);
+    return OutputFiles(outdir);
+}
+
+/**
+ * Generates LLVM code for the input with the config into its output directory. Returns the error if it failed.
+ */
+static std::string generate_llvm(const Input& input, const OutputFiles& output_files, const Config& config)
+{
+    try
     {
         Lexer lexer(input.content);
         Parser parser(lexer);
         auto program = parser.parse();
         program->ir_codegen();
+        program->ir_optimize(config.options);
+
+        if (config.lto)
+        {
+            llvm::LLVMContext llvm_context;
+            std::vector<std::unique_ptr<llvm::Module>> modules;
+            modules.push_back(codegen(program, llvm_context, config.options));
+            auto module = link_time_optimize(std::move(modules), {}, llvm_context);
 
-        auto output_files = get_output_files(input.test_id);
+            std::error_code error_code;
+            llvm::raw_fd_ostream ll_file(output_files.ll_filepath, error_code);
+            module->print(ll_file, nullptr);
+        }
+        else
         {
             auto ll_file = std::ofstream(output_files.ll_filepath);
-            EXPECT_NO_THROW({
-                codegen(program, &ll_file);
-            }) << "Error for test " << input.test_id;
-        }
-        
-        // link the LLVM files into an executable
-        execute(input.test_id, "llvm-link-18 " + output_files.ll_filepath + " " + test_code_path + " -S -o " + output_files.s_filepath);
-        execute(input.test_id, "llc-18 " + output_files.s_filepath + " -o " + output_files.s_filepath);
-        execute(input.test_id, "llvm-link-18 " + output_files.ll_filepath + " " + test_code_path + " -o " + output_files.exe_filepath);
-        execute(input.test_id, "chmod u+x " + output_files.exe_filepath);
-
-        // run the generated executable
-        execute(input.test_id, "./" + output_files.exe_filepath + " > " + output_files.out_filepath + " ; echo exit status: $? >> " + output_files.out_filepath, false);
-
-        // link the C files using clang to compare output
-        execute(input.test_id, "clang-18 -c Tests/test-link/test-code.c -o Tests/test-link/test-code.o");
-        execute(input.test_id, "clang-18 " + input.filepath + " Tests/test-link/test-code.o -o " + output_files.ref_exe_filepath);
-        execute(input.test_id, "./" + output_files.ref_exe_filepath + " > " + output_files.ref_out_filepath + " ; echo exit status: $? >> " + output_files.ref_out_filepath, false);
-
-        execute(input.test_id, "diff " + output_files.ref_out_filepath + " " + output_files.out_filepath + " > " + output_files.diff_filepath);
-
-        std::ifstream diff(output_files.diff_filepath);
-        EXPECT_TRUE(diff.good()) << "failed to create diff for test " << input.test_id;
-
-        std::stringstream buffer;
-        buffer << diff.rdbuf();
-        auto diff_content = buffer.str();
-        EXPECT_TRUE(diff_content.empty()) << "actual output did not match expected output for test " << input.test_id;
+            codegen(program, &ll_file, config.options);
+        }
+    }
+    catch (std::exception& e)
+    {
+        return std::string("codegen failed: ") + e.what();
+    }
+
+    return "";
+}
+
+/**
+ * Links the generated LLVM code into an executable and runs it. This runs on a worker thread, so it only runs
+ * commands on the output directory of the input.
+ */
+static CodegenResult build_and_run(const OutputFiles& output_files)
+{
+    std::vector<std::string> commands = {
+        "llvm-link-18 " + output_files.ll_filepath + " " + test_code_path + " -o " + output_files.exe_filepath,
+        "llc-18 " + output_files.exe_filepath + " -o " + output_files.s_filepath,
+    };
+
+    for (auto& cmd : commands)
+    {
+        if (execute(cmd) != 0)
+        {
+            return { "command: " + cmd + " failed to execute" };
+        }
+    }
+
+    std::filesystem::permissions(output_files.exe_filepath, std::filesystem::perms::owner_exec, std::filesystem::perm_options::add);
+    return { "", run(output_files.exe_filepath, output_files.out_filepath) };
+}
+
+/**
+ * Builds and runs the input with clang to get the expected output, then builds and runs the code generated for each
+ * config. The result of each config is set as soon as it is known.
+ */
+static void build_and_run(Job& job)
+{
+    auto ref_cmd = "clang-18 " + job.input.filepath + " " + runtime_filepath + " -o " + job.ref_files.ref_exe_filepath;
+    auto ref_error = execute(ref_cmd) != 0 ? "command: " + ref_cmd + " failed to execute" : "";
+    auto ref_output = ref_error.empty() ? run(job.ref_files.ref_exe_filepath, job.ref_files.ref_out_filepath) : "";
+
+    for (auto i = 0; i < configs.size(); i++)
+    {
+        auto error = !job.errors[i].empty() ? job.errors[i] : ref_error;
+        auto result = error.empty() ? build_and_run(job.output_files[i]) : CodegenResult { error };
+        result.ref_output = ref_output;
+        job.results[i].set_value(result);
+    }
+}
+
+/**
+ * Builds and runs every input on a pool of workers before the tests check them, so the suite takes about as long
+ * as its slowest inputs on each core. The LLVM code is generated up front on the main thread, since the compiler
+ * itself is not thread safe. Each input is compiled with every config, and clang builds it once for all of them.
+ */
+class Codegen : public ::testing::TestWithParam<std::tuple<Input, Config>>
+{
+private:
+    static inline std::vector<Job> jobs;
+    static inline std::atomic<std::size_t> next_job;
+    static inline std::vector<std::thread> workers;
+
+    static void work()
+    {
+        for (auto i = next_job++; i < jobs.size(); i = next_job++)
+        {
+            build_and_run(jobs[i]);
+        }
+    }
+
+protected:
+    static inline std::map<std::pair<int, std::string>, std::shared_future<CodegenResult>> results;
+
+public:
+    static void SetUpTestCase()
+    {
+        std::string runtime_error;
+        if (execute("clang-18 -c Tests/test-link/test-code.c -o " + runtime_filepath) != 0)
+        {
+            runtime_error = "failed to build the test runtime";
+        }
+
+        jobs.reserve(all_inputs.size());
+        for (auto& input : all_inputs)
+        {
+            auto& job = jobs.emplace_back(Job { input, get_output_files(input.test_id) });
+            for (auto& config : configs)
+            {
+                job.output_files.push_back(get_output_files(input, config));
+                job.errors.push_back(runtime_error.empty() ? generate_llvm(input, job.output_files.back(), config) : runtime_error);
+                results[{ input.test_id, config.name }] = job.results.emplace_back().get_future().share();
+            }
+        }
+
+        next_job = 0;
+        for (auto i = 0; i < test_jobs; i++)
+        {
+            workers.emplace_back(work);
+        }
+    }
+
+    static void TearDownTestCase()
+    {
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        workers.clear();
+        jobs.clear();
+        results.clear();
+    }
+};
+
+TEST_P(Codegen, Input)
+{
+    auto& [input, config] = GetParam();
+    auto it = results.find({ input.test_id, config.name });
+    if (it == results.end())
+    {
+        // the input was not selected with --test
+        return;
+    }
+
+    auto result = it->second.get();
+    ASSERT_TRUE(result.error.empty()) << result.error << " for test " << input.test_id << " with " << config.name;
+    EXPECT_EQ(result.ref_output, result.output) << "actual output did not match expected output for test " << input.test_id << " with " << config.name;
+}
+
+INSTANTIATE_TEST_CASE_P(All, Codegen, ::testing::Combine(::testing::ValuesIn(read_all_inputs()), ::testing::ValuesIn(configs)), [](const ::testing::TestParamInfo<std::tuple<Input, Config>>& info)
+{
+    return "test" + std::to_string(std::get<0>(info.param).test_id) + "_" + std::get<1>(info.param).name;
+});
+
+/**
+ * Compiles the input to an LLVM module.
+ */
+static std::unique_ptr<llvm::Module> compile(const std::string& input, llvm::LLVMContext& llvm_context)
+{
+    Lexer lexer(input);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    program->ir_codegen();
+    program->ir_optimize();
+    return codegen(program, llvm_context);
+}
+
+/**
+ * Counts the instructions of the function with the opcode, and how many of them have the nsw flag.
+ */
+static std::pair<int, int> count_nsw(llvm::Module& module, const std::string& function, unsigned opcode)
+{
+    auto count = 0;
+    auto nsw = 0;
+    for (auto& inst : llvm::instructions(module.getFunction(function)))
+    {
+        if (inst.getOpcode() == opcode)
+        {
+            count++;
+            nsw += llvm::cast<llvm::OverflowingBinaryOperator>(inst).hasNoSignedWrap();
+        }
+    }
+
+    return { count, nsw };
+}
+
+TEST(LLVM, NoSignedWrap)
+{
+    std::string input = "int mul(int x, int y) { return x * y + (x - y); }"
+        "unsigned umul(unsigned x, unsigned y) { return x * y; }"
+        "int mul_minus_two(int x) { return x * -2; }";
+
+    llvm::LLVMContext llvm_context;
+    auto module = compile(input, llvm_context);
+
+    // signed overflow is undefined in the source
+    EXPECT_EQ(count_nsw(*module, "mul", llvm::Instruction::Mul), std::make_pair(1, 1));
+    EXPECT_EQ(count_nsw(*module, "mul", llvm::Instruction::Add), std::make_pair(1, 1));
+    EXPECT_EQ(count_nsw(*module, "mul", llvm::Instruction::Sub), std::make_pair(1, 1));
+    EXPECT_EQ(count_nsw(*module, "umul", llvm::Instruction::Mul), std::make_pair(1, 0));
+
+    // x * -2 is reduced to -(x << 1), which wraps for x = 2^30 even though the product does not
+    EXPECT_EQ(count_nsw(*module, "mul_minus_two", llvm::Instruction::Mul), std::make_pair(0, 0));
+    EXPECT_EQ(count_nsw(*module, "mul_minus_two", llvm::Instruction::Shl), std::make_pair(1, 0));
+    EXPECT_EQ(count_nsw(*module, "mul_minus_two", llvm::Instruction::Sub), std::make_pair(1, 0));
+}
+
+TEST(LLVM, TBAA)
+{
+    std::string input = "void copy(int a[], char b[], int n) { int i; for (i = 0; i < n; i++) { b[i] = a[i]; } }";
+
+    llvm::LLVMContext llvm_context;
+    auto module = compile(input, llvm_context);
+
+    // the int loads and char stores through the arrays get different tags, and since a char may access any object,
+    // the type of the int tag is a child of the type of the char tag, so LLVM knows that they may alias
+    std::set<llvm::MDNode *> load_tags, store_tags;
+    for (auto& inst : llvm::instructions(module->getFunction("copy")))
+    {
+        auto tag = inst.getMetadata(llvm::LLVMContext::MD_tbaa);
+        if (llvm::isa<llvm::LoadInst>(inst) && inst.getType()->getScalarType()->isIntegerTy(32))
+        {
+            ASSERT_NE(tag, nullptr);
+            load_tags.insert(tag);
+        }
+        else if (llvm::isa<llvm::StoreInst>(inst) && inst.getOperand(0)->getType()->getScalarType()->isIntegerTy(8))
+        {
+            ASSERT_NE(tag, nullptr);
+            store_tags.insert(tag);
+        }
+    }
+
+    EXPECT_FALSE(load_tags.empty());
+    EXPECT_FALSE(store_tags.empty());
+    for (auto tag : load_tags)
+    {
+        EXPECT_EQ(store_tags.count(tag), 0);
+
+        // a tag is { base type, access type, offset }, and a scalar type is { name, parent, offset }
+        auto int_node = llvm::cast<llvm::MDNode>(tag->getOperand(0));
+        for (auto store_tag : store_tags)
+        {
+            EXPECT_EQ(int_node->getOperand(1).get(), store_tag->getOperand(0).get());
+        }
+    }
+}
+
+/**
+ * Compiles the program with the options into its own output directory and runs it, returning what it printed and
+ * its exit status.
+ */
+static std::string compile_and_run(const std::string& name, const std::string& input, const Options& options)
+{
+    auto outdir = "Tests/out/" + name;
+    std::filesystem::create_directories(outdir);
+    OutputFiles output_files(outdir);
+
+    auto error = generate_llvm(Input(0, name, input), output_files, Config { name, options });
+    if (!error.empty())
+    {
+        return error;
+    }
+
+    if (execute("llvm-link-18 " + output_files.ll_filepath + " " + test_code_path + " -o " + output_files.exe_filepath) != 0)
+    {
+        return "failed to link " + name;
+    }
+
+    std::filesystem::permissions(output_files.exe_filepath, std::filesystem::perms::owner_exec, std::filesystem::perm_options::add);
+    return run(output_files.exe_filepath, output_files.out_filepath);
+}
+
+TEST(LLVM, BoundsCheck)
+{
+    // the checks of both loops are moved before them, and the last index of the first is n + 1
+    std::string functions = "extern void println(int n);"
+        "int sum_shifted(int n) { int a[8]; int i; int s = 0; for (i = 0; i < 8; i++) { a[i] = i; }"
+        "    for (i = 0; i < n; i++) { s = s + a[i + 2]; } return s; }"
+        "int sum_near_max(int n) { int a[8]; int i; int s = 0; for (i = 0; i < 8; i++) { a[i] = i; }"
+        "    for (i = 2147483640; i < n; i++) { s = s + a[i - 2147483640]; } return s; }"
+        "int at_char(char c) { int a[300]; int i; for (i = 0; i < 300; i++) { a[i] = i; } return a[c]; }"
+        "int at_char_small(char c) { int a[200]; int i; for (i = 0; i < 200; i++) { a[i] = i; } return a[c]; }";
+
+    Options options;
+    options.bounds_check = true;
+    auto program = [&](const std::string& call) { return functions + "int main() { println(" + call + "); return 0; }"; };
+
+    EXPECT_EQ(compile_and_run("bounds-in-range", program("sum_shifted(6)"), options), "27\nexit status: 0\n");
+    EXPECT_EQ(compile_and_run("bounds-near-max", program("sum_near_max(2147483647)"), options), "21\nexit status: 0\n");
+
+    // a char index is compared with the whole size, which does not fit in a char
+    EXPECT_EQ(compile_and_run("bounds-char", program("at_char(50)"), options), "50\nexit status: 0\n");
+
+    // the loop would read a[8] in its last iteration, n + 1 overflows for the largest n, and a negative char index is
+    // not a large unsigned one, so each traps before printing anything
+    for (auto call : { "sum_shifted(7)", "sum_shifted(2147483647)", "at_char_small(-100)" })
+    {
+        auto output = compile_and_run("bounds-out-of-range", program(call), options);
+        EXPECT_EQ(output.rfind("exit status: ", 0), 0) << output << " for " << call;
+        EXPECT_NE(output, "exit status: 0\n") << call;
     }
 }
@@ -2,6 +2,7 @@
 #include "Environment.hpp"
 
 std::vector<Input> all_inputs;
+int test_jobs = 1;
 
 void Environment::SetUp() 
 {
@@ -15,5 +16,6 @@ void Environment::SetUp()
         all_inputs.push_back(read_input(t));
     }
     
+    test_jobs = args.jobs;
     clear_outdir();
 }
@@ -6,6 +6,7 @@
 #include "TestUtils.hpp"
 
 extern std::vector<Input> all_inputs;
+extern int test_jobs;
 
 class Environment : public ::testing::Environment {
 private:
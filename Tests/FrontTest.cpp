@@ -6,6 +6,7 @@
 #include "Environment.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
+#include "Error.hpp"
 
 TEST(Front, Lexer)
 {
@@ -28,3 +29,49 @@ TEST(Front, Parser)
         }) << "Error for test " << input.test_id;
     }
 }
+
+TEST(Front, SwitchCaseValues)
+{
+    // the case values are converted to the promoted type of the guard, which is int for a char
+    std::string input = "int f(char c) { switch (c) { case 1: return 1; case 257: return 2; } return 0; }";
+    Lexer lexer(input);
+    EXPECT_NO_THROW({
+        Parser parser(lexer);
+        parser.parse();
+    });
+
+    input = "int f(unsigned int u) { switch (u) { case 1: return 1; case 4294967297: return 2; } return 0; }";
+    Lexer duplicate_lexer(input);
+    EXPECT_THROW({
+        Parser parser(duplicate_lexer);
+        parser.parse();
+    }, TypeError);
+}
+
+TEST(Front, IntegerConstants)
+{
+    std::string input = "unsigned long f() { return 18446744073709551615UL; }";
+    Lexer lexer(input);
+    EXPECT_NO_THROW({
+        Parser parser(lexer);
+        parser.parse();
+    });
+
+    // a constant too large for any type is an error, not an exception from the conversion
+    input = "unsigned long f() { return 18446744073709551616; }";
+    Lexer too_large_lexer(input);
+    EXPECT_THROW({
+        Parser parser(too_large_lexer);
+        parser.parse();
+    }, Error);
+}
+
+TEST(Front, UnrollPragma)
+{
+    std::string input = "void f(int a[]) { int i;\n#pragma unroll 99999999999\nfor (i = 0; i < 8; i++) { a[i] = 0; } }";
+    Lexer lexer(input);
+    EXPECT_THROW({
+        Parser parser(lexer);
+        parser.parse();
+    }, Error);
+}
@@ -1,11 +1,15 @@
 #include <iostream>
 #include <vector>
+#include <map>
+#include <algorithm>
 #include <gtest/gtest.h>
 #include "TestUtils.hpp"
 #include "Environment.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
 #include "Quad.hpp"
+#include "Liveness.hpp"
+#include "Fingerprint.hpp"
 
 TEST(IR, Codegen)
 {
@@ -28,3 +32,234 @@ TEST(IR, Codegen)
         }
     }
 }
+
+
+TEST(IR, Liveness)
+{
+    for (auto& input : all_inputs)
+    {
+        Lexer lexer(input.content);
+        Parser parser(lexer);
+        auto program = parser.parse();
+        program->ir_codegen();
+        EXPECT_NO_THROW({
+            program->ir_optimize();
+        }) << "Error for test " << input.test_id;
+
+        for (auto f : program->functions)
+        {
+            if (f->is_proto())
+            {
+                continue;
+            }
+
+            // nothing can be live on entry except for parameters
+            for (auto symbol : f->cfg.front()->live_in)
+            {
+                EXPECT_FALSE(symbol->is_temp) << "temp live on entry for test " << input.test_id;
+            }
+
+            for (auto& block : f->cfg)
+            {
+                EXPECT_GE(block->max_live, block->live_in.size());
+                EXPECT_GE(block->max_live, block->live_out.size());
+            }
+        }
+    }
+}
+
+TEST(IR, BoundsCheck)
+{
+    std::string input =
+        "int get(int k) { int a[4]; int i; for (i = 0; i < 4; i++) { a[i] = i; } return a[k] + a[k & 3]; }\n"
+        "int fill(int n) { int b[8]; int i; for (i = 0; i < n; i++) { b[i] = i; } return b[0]; }\n";
+
+    Lexer lexer(input);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    program->ir_codegen();
+
+    Options options;
+    options.bounds_check = true;
+    options.vectorize = false;
+    program->ir_optimize(options);
+
+    // only a[k] needs a check, and the checks for b[i] are moved before the loop, where only the last index is checked,
+    // since the loop starts at 0, which is in bounds
+    std::vector<int> expected = { 1, 1 };
+    for (auto i = 0; i < program->functions.size(); i++)
+    {
+        auto checks = 0;
+        for (auto quad = program->functions[i]->ir_list.get_head(); quad != nullptr; quad = quad->next)
+        {
+            if (quad->op == QuadOp::Check)
+            {
+                checks++;
+            }
+        }
+
+        EXPECT_EQ(checks, expected[i]) << "wrong number of checks in " << program->functions[i]->function->get_name();
+    }
+}
+
+TEST(IR, PromoteGlobals)
+{
+    std::string input =
+        "extern void println(int n);\n"
+        "int total;\n"
+        "void sum(int n) { int i; for (i = 0; i < n; i++) { total = total + i; } }\n"
+        "void print(int n) { int i; for (i = 0; i < n; i++) { total = total + i; println(total); } }\n";
+
+    Lexer lexer(input);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    program->ir_codegen();
+
+    Options options;
+    options.whole_program = true;
+    program->ir_optimize(options);
+
+    // println cannot touch total when the whole program is visible, so it is only loaded on entry and stored on exit
+    for (auto& f : program->functions)
+    {
+        if (f->is_proto())
+        {
+            continue;
+        }
+
+        auto accesses = 0;
+        for (auto quad = f->ir_list.get_head(); quad != nullptr; quad = quad->next)
+        {
+            for (auto operand : { quad->arg1, quad->arg2, quad->res })
+            {
+                if (operand != nullptr && operand->type == OperandType::Variable && operand->symbol->get_name() == "total")
+                {
+                    accesses++;
+                }
+            }
+        }
+
+        EXPECT_EQ(accesses, 2) << "wrong number of accesses to total in " << f->function->get_name();
+    }
+}
+
+TEST(IR, SpecializeFunctions)
+{
+    std::string input =
+        "int scale(int x, int factor) { return x * factor; }\n"
+        "int unused(int n) { return n + 1; }\n"
+        "int main() { return scale(2, 3) + scale(4, 3); }\n";
+
+    Lexer lexer(input);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    program->ir_codegen();
+
+    Options options;
+    options.whole_program = true;
+    program->ir_optimize(options);
+
+    // scale is always called with factor = 3, so its calls go to a clone without the parameter, and unused is removed
+    std::vector<std::string> expected = { "scale.3", "main" };
+    ASSERT_EQ(program->functions.size(), expected.size());
+    for (auto i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(program->functions[i]->function->get_name(), expected[i]);
+    }
+
+    EXPECT_EQ(program->functions[0]->params.size(), 1);
+
+    // without the whole program other files may call scale, so it is not cloned
+    Lexer separate_lexer(input);
+    Parser separate_parser(separate_lexer);
+    program = separate_parser.parse();
+    program->ir_codegen();
+    program->ir_optimize();
+
+    expected = { "scale", "unused", "main" };
+    ASSERT_EQ(program->functions.size(), expected.size());
+    for (auto i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(program->functions[i]->function->get_name(), expected[i]);
+    }
+
+    // only so many functions are cloned
+    std::string many;
+    std::string calls;
+    for (auto i = 0; i < 20; i++)
+    {
+        many += "int f" + std::to_string(i) + "(int x) { return x + 1; }\n";
+        calls += " + f" + std::to_string(i) + "(" + std::to_string(i) + ")";
+    }
+
+    Lexer many_lexer(many + "int main() { return 0" + calls + "; }\n");
+    Parser many_parser(many_lexer);
+    program = many_parser.parse();
+    program->ir_codegen();
+
+    options = Options();
+    options.whole_program = true;
+    program->ir_optimize(options);
+    auto clones = std::count_if(program->functions.begin(), program->functions.end(), [](auto& f) { return f->function->get_name().find('.') != std::string::npos; });
+    EXPECT_EQ(clones, 16);
+}
+
+TEST(IR, FunctionAttributes)
+{
+    std::string input =
+        "extern void println(int n);\n"
+        "int total;\n"
+        "int square(int x) { return x * x; }\n"
+        "int get() { return total; }\n"
+        "int count(int n) { if (n == 0) { return 0; } return count(n - 1) + 1; }\n"
+        "int main() { println(square(get()) + count(3)); return 0; }\n";
+
+    Lexer lexer(input);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    program->ir_codegen();
+    program->ir_optimize(Options());
+
+    std::map<std::string, FunctionAttributes> attributes;
+    for (auto& f : program->functions)
+    {
+        attributes[f->function->get_name()] = f->attributes;
+    }
+
+    EXPECT_TRUE(attributes["square"].readnone && attributes["square"].willreturn && attributes["square"].norecurse);
+    EXPECT_TRUE(!attributes["get"].readnone && attributes["get"].readonly);
+    EXPECT_TRUE(attributes["count"].readnone && !attributes["count"].norecurse && !attributes["count"].willreturn);
+    EXPECT_TRUE(!attributes["main"].readonly && !attributes["main"].norecurse && attributes["main"].nounwind);
+    EXPECT_FALSE(attributes["square"].internal);
+}
+
+TEST(IR, FingerprintFunctions)
+{
+    std::string clamp = "int clamp(int x) { if (x > 10) { return 10; } return x; }\n";
+    std::vector<std::string> inputs = {
+        clamp + "int main() { return clamp(3); }\n",
+        "int sign(int x) { if (x < 0) { return -1; } return 1; }\n" + clamp + "int main() { return clamp(3) + sign(2); }\n",
+        "int clamp(int x) { if (x > 20) { return 20; } return x; }\nint main() { return clamp(3); }\n",
+    };
+
+    std::vector<std::string> fingerprints;
+    for (auto& input : inputs)
+    {
+        Lexer lexer(input);
+        Parser parser(lexer);
+        auto program = parser.parse();
+        program->ir_codegen();
+        for (auto& [def, fingerprint] : FingerprintFunctions(program->functions))
+        {
+            if (def->function->get_name() == "clamp")
+            {
+                fingerprints.push_back(fingerprint);
+            }
+        }
+    }
+
+    // the labels of clamp are numbered differently once sign comes first, but its fingerprint is the same
+    ASSERT_EQ(fingerprints.size(), 3);
+    EXPECT_EQ(fingerprints[0], fingerprints[1]);
+    EXPECT_NE(fingerprints[0], fingerprints[2]);
+}
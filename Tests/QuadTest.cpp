@@ -29,3 +29,20 @@ TEST(Quad, Test_QuadList)
 
     EXPECT_EQ(i, 3);
 }
+
+TEST(Quad, Test_QuadList_InsertAfter)
+{
+    auto enter = Quad::MakeEnterOp(nullptr);
+    auto ret = enter->next = Quad::MakeReturnOp(nullptr);
+    QuadList list(enter, ret);
+
+    auto param = Quad::MakeParamOp(nullptr);
+    list.insert_after(enter, param);
+    EXPECT_EQ(enter->next, param);
+    EXPECT_EQ(param->next, ret);
+    EXPECT_EQ(list.get_tail(), ret);
+
+    auto ret2 = Quad::MakeReturnOp(nullptr);
+    list.insert_after(ret, ret2);
+    EXPECT_EQ(list.get_tail(), ret2);
+}
@@ -27,15 +27,13 @@ struct OutputFiles
     std::string out_filepath;
     std::string ref_exe_filepath;
     std::string ref_out_filepath;
-    std::string diff_filepath;
     OutputFiles(std::string outdir) :
         ll_filepath(outdir + "/act.ll"),
         s_filepath(outdir + "/act.s"),
         exe_filepath(outdir + "/act.exe"),
         out_filepath(outdir + "/act.out"),
         ref_exe_filepath(outdir + "/ref.exe"),
-        ref_out_filepath(outdir + "/ref.out"),
-        diff_filepath(outdir + "/diff.out")
+        ref_out_filepath(outdir + "/ref.out")
     {}
 };
 
@@ -0,0 +1,113 @@
+extern void println(int n);
+
+int classify(int op)
+{
+    int r = 0;
+    switch (op)
+    {
+        case 0:
+            r = 10;
+            break;
+        case 1:
+        case 2:
+            r = 20;
+            break;
+        case 3:
+            r = 30;
+        case 4:
+            r = r + 40;
+            break;
+        case -1:
+            return -100;
+        default:
+            r = 0;
+    }
+
+    return r;
+}
+
+int run(int n)
+{
+    int pc = 0, acc = 0, steps = 0;
+    while (1)
+    {
+        steps++;
+        switch (pc)
+        {
+            case 0:
+                acc = acc + n;
+                pc = 1;
+                break;
+            case 1:
+                acc = acc * 3;
+                pc = 2;
+                break;
+            case 2:
+                acc = acc - 3;
+                pc = 3;
+                break;
+            case 3:
+                if (acc > 1000)
+                {
+                    pc = 4;
+                }
+                else
+                {
+                    pc = 1;
+                }
+
+                break;
+        }
+
+        if (pc == 4)
+        {
+            break;
+        }
+    }
+
+    return acc + steps;
+}
+
+int classify_char(char c)
+{
+    // the cases are compared with c promoted to int, so 255 and 300 never match
+    switch (c)
+    {
+        case -1:
+            return 1;
+        case 255:
+            return 2;
+        case 300:
+            return 3;
+        case 44:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+int main()
+{
+    int i;
+    for (i = -2; i < 7; i++)
+    {
+        println(classify(i));
+    }
+
+    int count = 0;
+    for (;;)
+    {
+        count++;
+        if (count == 5)
+        {
+            break;
+        }
+    }
+
+    println(count);
+    println(run(3));
+    println(classify_char(-1));
+    println(classify_char(44));
+    println(classify_char(0));
+    return 0;
+}
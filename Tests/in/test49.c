@@ -0,0 +1,62 @@
+extern void println(int n);
+
+int calls;
+
+int check(int n)
+{
+    calls = calls + 1;
+    return n > 2;
+}
+
+int main()
+{
+    int a = 1, b = 2, c = 3, zero = 0;
+    int x;
+
+    x = a < b && c;
+    println(x);
+
+    x = a > b || c == 3;
+    println(x);
+
+    x = !(a == b);
+    println(x);
+
+    x = !c;
+    println(x);
+
+    x = (a < b) + (b < c) + (c < a);
+    println(x);
+
+    // the rhs divides, so it must only run when zero is not 0
+    x = zero != 0 && 10 / zero > 1;
+    println(x);
+
+    x = b != 0 && 10 / b > 1;
+    println(x);
+
+    // the rhs calls a function, so it must only run when the lhs does not decide the result
+    calls = 0;
+    x = check(1) && check(5);
+    println(x);
+    println(calls);
+
+    calls = 0;
+    x = check(3) || check(5);
+    println(x);
+    println(calls);
+
+    calls = 0;
+    x = check(1) || check(5);
+    println(x);
+    println(calls);
+
+    int i, count = 0;
+    for (i = 0; i < 20; i++)
+    {
+        count += i > 5 && i < 15;
+    }
+
+    println(count);
+    return a <= b == 1;
+}
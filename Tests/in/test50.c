@@ -0,0 +1,69 @@
+extern void println(int n);
+
+int hash(int n)
+{
+    int h = 5381;
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        h = ((h << 5) ^ (h >> 3) ^ i) & 16777215;
+    }
+
+    return h;
+}
+
+int pack(int r, int g, int b)
+{
+    return (r & 255) << 16 | (g & 255) << 8 | b & 255;
+}
+
+int main()
+{
+    int i, x, sum;
+
+    println(hash(100));
+    println(pack(18, 52, 86));
+    println(pack(18, 52, 86) >> 8 & 255);
+    println(~0);
+    println(~12 ^ 5);
+    println(-17 >> 2);
+    println(1 | 2 ^ 3 & 4);
+    println(1 << 2 + 1);
+
+    x = 6;
+    x &= 3;
+    println(x);
+    x |= 12;
+    println(x);
+    x ^= 5;
+    println(x);
+    x <<= 3;
+    println(x);
+    x >>= 2;
+    println(x);
+
+    // multiply, divide, and modulo by constants
+    sum = 0;
+    for (i = -100; i <= 100; i += 7)
+    {
+        sum = sum + i * 8 + i * -16 + i * 0 + i * 1 + i * 3;
+        sum = sum + i / 1 + i / -1 + i / 8 + i / -4 + i / 3 + i / 7 + i / -7 + i / 10 + i / 641;
+        sum = sum + i % 1 + i % 8 + i % -4 + i % 3 + i % 7 + i % -7 + i % 10;
+        println(i / 6 + i % 6 * 1000);
+    }
+
+    println(sum);
+
+    x = -2147483647 - 1;
+    println(x / 7);
+    println(x % 7);
+    println(x / 8);
+    println(x % 8);
+    println(x / -2147483647);
+    println(2147483647 / 3);
+    x = 2147483647;
+    println(x / 3);
+    println(x % 1000000007);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <stdint.h>
+#include <stddef.h>
+
+extern void println(int n);
+
+uint64_t fnv1a(int n)
+{
+    uint64_t h = 14695981039346656037UL;
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        h = h ^ (uint64_t)(i & 255);
+        h = h * 1099511628211UL;
+    }
+
+    return h;
+}
+
+void print64(uint64_t x)
+{
+    println((int)(x >> 32));
+    println((int)(x & 4294967295UL));
+}
+
+long sum_to(long n)
+{
+    long total = 0;
+    long i;
+    for (i = 1; i <= n; i++)
+    {
+        total += i;
+    }
+
+    return total;
+}
+
+int main()
+{
+    unsigned int u = 0;
+    unsigned int big = 4294967295u;
+    int s = -1;
+    long counter = 0;
+    unsigned long ul;
+    int8_t small = 127;
+    uint8_t byte = 250;
+    int16_t half = -30000;
+    uint32_t word;
+    size_t len = 10;
+    char c;
+
+    // unsigned comparisons, division, modulo, and shifts
+    u = u - 1;
+    println(u > 0);
+    println(u == big);
+    println(s < 0);
+    println((unsigned int)s > 100u);
+    println(u / 3 == 1431655765);
+    println(u % 10);
+    println(u >> 28);
+    println(s >> 28);
+    println(u / 16 == 268435455);
+    println(u % 16);
+    println((int)(big / 7));
+
+    // 64 bit arithmetic
+    counter = 3000000000;
+    counter = counter * 4;
+    println(counter > 2147483647);
+    println((int)(counter / 1000000));
+    print64(fnv1a(1000));
+    print64(sum_to(100000));
+    ul = 18446744073709551615UL;
+    println(ul > 0);
+    println((int)(ul % 1000));
+    println((int)(ul / 10000000000000UL));
+    print64(ul >> 1);
+    println((long)ul < 0);
+
+    // wrap around of small types
+    small = small + 1;
+    println(small);
+    byte = byte + 10;
+    println(byte);
+    half = half - 5000;
+    println(half);
+    c = 65;
+    println(c + 1);
+    word = 4000000000u;
+    println(word / 1000);
+    len = len * 3;
+    println((int)len);
+    println(-7 / 2);
+    println(-7 % 2);
+    println((long)-7 / 2);
+    println(-7L % 2);
+
+    return 0;
+}
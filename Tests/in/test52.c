@@ -0,0 +1,89 @@
+extern void println(int n);
+
+double dot(double a[], double b[], int n)
+{
+    double sum = 0.0;
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+float average(float x, float y)
+{
+    return (x + y) / 2;
+}
+
+double poly(double x)
+{
+    return 3.5 * x * x - 2.0 * x + 1e-1;
+}
+
+int sign(double x)
+{
+    if (x < 0)
+    {
+        return -1;
+    }
+    else if (x > 0.0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    double a[8];
+    double b[8];
+    int i;
+    for (i = 0; i < 8; i++)
+    {
+        a[i] = i * 0.5;
+        b[i] = 8 - i;
+    }
+
+    println((int)dot(a, b, 8));
+    println((int)(dot(a, b, 8) * 1000));
+
+    float f = average(1.25f, 2.5f);
+    println((int)(f * 100));
+
+    double x = 1.5;
+    x++;
+    x -= 0.25;
+    x *= 4;
+    x /= 3.0;
+    println((int)(x * 1000000));
+    println((int)(poly(x) * 1000));
+    println((int)-x);
+
+    println(sign(-x));
+    println(sign(x));
+    println(sign(0));
+    println(x == 3.0);
+    println(x != 3.0);
+    println(x >= 3 && x <= 3.0);
+    println(!x);
+    println(!(x - x));
+
+    unsigned int u = 4000000000U;
+    double d = u;
+    println((int)(d / 1000));
+    println((int)(unsigned int)(d - 1.0) == (int)(u - 1));
+
+    long big = 1L << 40;
+    double db = big;
+    println((int)(db / 1099511627776.0));
+
+    float narrow = 0.1;
+    double wide = narrow;
+    println(wide == 0.1);
+    println(narrow == 0.1f);
+
+    return 0;
+}
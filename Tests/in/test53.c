@@ -0,0 +1,136 @@
+#include <stdint.h>
+
+extern void println(int n);
+
+int ga[37];
+int gb[37];
+int gc[37];
+
+void add_globals(int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        ga[i] = gb[i] + gc[i];
+    }
+}
+
+int add_arrays(int n)
+{
+    int a[37];
+    int b[37];
+    int c[37];
+    int i;
+    for (i = 0; i < 37; i++)
+    {
+        b[i] = i;
+        c[i] = 100 - 2 * i;
+        a[i] = 0;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        a[i] = b[i] + c[i];
+    }
+
+    return a[0] + a[n - 1] + a[n];
+}
+
+int scale(int a[], int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        a[i] = a[i] * 3;
+    }
+
+    return a[n - 1];
+}
+
+int main()
+{
+    println(add_arrays(36));
+    println(add_arrays(2));
+    println(add_arrays(4));
+    println(add_arrays(5));
+
+    int i;
+    for (i = 0; i < 37; i++)
+    {
+        gb[i] = i;
+        gc[i] = 100 - 2 * i;
+    }
+
+    add_globals(37);
+    println(ga[0]);
+    println(ga[35]);
+    println(ga[36]);
+
+    add_globals(2);
+    println(ga[1]);
+
+    float x[19];
+    float y[19];
+    float z[19];
+    for (i = 0; i < 19; i++)
+    {
+        x[i] = i * 0.5f;
+        y[i] = 2.0f;
+    }
+
+    float k = 1.5f;
+    for (i = 0; i < 19; i++)
+    {
+        z[i] = x[i] * y[i] + k;
+    }
+
+    println((int)(z[0] * 10));
+    println((int)(z[17] * 10));
+    println((int)(z[18] * 10));
+
+    long big[10];
+    long neg[10];
+    for (i = 0; i < 10; i++)
+    {
+        big[i] = i * 100000000000L;
+    }
+
+    for (i = 0; i <= 9; i++)
+    {
+        neg[i] = (0 - big[i]) ^ 7;
+    }
+
+    println((int)(neg[9] / 1000000));
+    println((int)(neg[1] % 1000));
+
+    uint8_t bytes[21];
+    uint8_t masked[21];
+    for (i = 0; i <= 20; i++)
+    {
+        bytes[i] = i * 13;
+    }
+
+    for (i = 0; i <= 20; i++)
+    {
+        masked[i] = (bytes[i] >> 1) ^ 170;
+    }
+
+    int sum = 0;
+    for (i = 0; i <= 20; i++)
+    {
+        sum += masked[i];
+    }
+
+    println(sum);
+
+    int d[6];
+    for (i = 0; i < 6; i++)
+    {
+        d[i] = i + 1;
+    }
+
+    println(scale(d, 6));
+    println(scale(gb, 5));
+    println(gb[4]);
+    return 0;
+}
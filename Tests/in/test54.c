@@ -0,0 +1,91 @@
+extern void println(int n);
+
+int sum_to(int n)
+{
+    int sum = 0;
+    int i;
+#pragma unroll(4)
+    for (i = 1; i <= n; i++)
+    {
+        sum = sum + i * i;
+    }
+
+    return sum;
+}
+
+int count_down(int n)
+{
+    int steps = 0;
+#pragma unroll
+    while (n > 0)
+    {
+        n = n - 3;
+        steps++;
+    }
+
+    return steps;
+}
+
+int count_by(int start)
+{
+    int steps = 0;
+    int i;
+#pragma unroll 30
+    for (i = start; i < 10; i += 100000000)
+    {
+        steps++;
+    }
+
+    return steps;
+}
+
+int main()
+{
+    int i;
+    int total = 0;
+#pragma unroll
+    for (i = 0; i < 10; i++)
+    {
+        total += i;
+    }
+
+    println(total);
+
+    int a[12];
+#pragma unroll 5
+    for (i = 0; i < 12; i += 2)
+    {
+        a[i] = i;
+        a[i + 1] = -i;
+    }
+
+    println(a[10] - a[11]);
+
+#pragma nounroll
+    for (i = 0; i < 3; i++)
+    {
+        total = total * 2;
+    }
+
+    println(total);
+
+    unsigned int u;
+    unsigned int hits = 0;
+#pragma unroll(8)
+    for (u = 0; u < 3; u++)
+    {
+        hits++;
+    }
+
+    println(hits);
+
+    println(sum_to(0));
+    println(sum_to(1));
+    println(sum_to(3));
+    println(sum_to(10));
+    println(sum_to(11));
+    println(count_down(10));
+    println(count_by(-2000000000));
+    println(count_by(5));
+    return 0;
+}
@@ -0,0 +1,53 @@
+extern void println(int n);
+
+int total;
+int calls;
+int seed;
+
+int next()
+{
+    calls++;
+    seed = (seed * 75 + 74) % 65537;
+    return seed;
+}
+
+void accumulate(int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        total = total + i;
+    }
+}
+
+void mix(int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        total = total + next() % 10;
+        if (total > 1000)
+        {
+            total = total - 1000;
+        }
+    }
+}
+
+int report()
+{
+    println(total);
+    return calls;
+}
+
+int main()
+{
+    seed = 1;
+    accumulate(10);
+    println(total);
+    mix(20);
+    println(report());
+    println(seed);
+    accumulate(50);
+    println(total);
+    return 0;
+}
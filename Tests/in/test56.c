@@ -0,0 +1,38 @@
+extern void println(int n);
+
+int scale(int x, int factor)
+{
+    return x * factor + factor / 3;
+}
+
+int sum_squares(int n)
+{
+    int sum = 0;
+    int i;
+    for (i = 1; i <= n; i++)
+    {
+        sum = sum + i * i;
+    }
+
+    return sum;
+}
+
+int report(int n, int limit)
+{
+    int total = sum_squares(limit);
+    println(scale(n, 7));
+    return total + scale(n + 1, 7);
+}
+
+int unused(int n)
+{
+    return n * 1000;
+}
+
+int main()
+{
+    println(report(1, 10));
+    println(report(5, 10));
+    println(report(-3, 10));
+    return 0;
+}
@@ -0,0 +1,35 @@
+extern void println(int n);
+
+int checksum(char s[], int n)
+{
+    int sum = 0;
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        sum = sum * 31 + s[i];
+    }
+
+    return sum;
+}
+
+int main()
+{
+    char text[12];
+    long wide[4];
+    unsigned int u;
+    int i;
+    for (i = 0; i < 12; i++)
+    {
+        text[i] = 97 + i;
+    }
+
+    for (u = 0; u < 4; u++)
+    {
+        wide[u] = u * 1000000000;
+    }
+
+    println(checksum(text, 12));
+    println(text[11] - text[0]);
+    println(wide[3] / 1000000);
+    return 0;
+}
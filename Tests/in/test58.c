@@ -0,0 +1,30 @@
+extern void println(int n);
+
+void add(int dst[restrict], int a[restrict 64], int b[restrict], int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        dst[i] = a[i] + b[i] * 3;
+    }
+}
+
+int main()
+{
+    int x[64];
+    int y[64];
+    int z[64];
+    int i;
+    for (i = 0; i < 64; i++)
+    {
+        x[i] = i;
+        y[i] = 64 - i;
+    }
+
+    add(z, x, y, 61);
+    println(z[0]);
+    println(z[30]);
+    println(z[60]);
+    println(z[59] + z[1]);
+    return 0;
+}
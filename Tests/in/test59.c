@@ -0,0 +1,21 @@
+extern void println(int n);
+
+int times_minus_two(int x)
+{
+    return x * -2;
+}
+
+long times_minus_four(long x)
+{
+    return x * -4;
+}
+
+int main()
+{
+    // the products are the minimum values of int and long, which do not overflow
+    println(times_minus_two(1073741824));
+    println(times_minus_two(-5));
+    println((int)(times_minus_four(2305843009213693952L) >> 32));
+    println((int)times_minus_four(-7L));
+    return 0;
+}
@@ -0,0 +1,38 @@
+extern void println(int n);
+
+int main()
+{
+    // each compound assignment computes in the promoted operand types before the result is narrowed
+    char c = 100;
+    c /= 300;
+    println(c);
+
+    short s = 1000;
+    s %= 70000;
+    println(s);
+
+    unsigned char u = 200;
+    u >>= 3;
+    println(u);
+
+    char d = -128;
+    d >>= 4;
+    println(d);
+
+    short t = 30000;
+    t /= -7;
+    println(t);
+
+    int x = 10;
+    x /= 2.5;
+    println(x);
+
+    int y = 10;
+    y += 3000000000L;
+    println(y);
+
+    int z = 7;
+    z *= 1.5;
+    println(z);
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "Server.hpp"
+
+/**
+ * A thin client for acc --server, which starts without loading LLVM. acc-client ARGS compiles like acc ARGS would.
+ */
+int main(int argc, char *argv[])
+{
+    try
+    {
+        return run_client(get_server_socket_path(), std::vector<std::string>(argv + 1, argv + argc));
+    }
+    catch (std::runtime_error& e)
+    {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -2,12 +2,61 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <thread>
 #include <stdlib.h>
 #include <tclap/CmdLine.h>
+#include <llvm/Support/raw_os_ostream.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/FileSystem.h>
 #include "Lexer.hpp"
 #include "Parser.hpp"
 #include "Codegen.hpp"
+#include "LTO.hpp"
+#include "CompileCache.hpp"
+#include "Server.hpp"
+#include "Report.hpp"
 #include "Error.hpp"
+#include "Options.hpp"
+
+/**
+ * Rewrites GCC style flags into the long options TCLAP understands, e.g. -ffast-math into --fast-math,
+ * -funroll-count=8 into --unroll-count 8, -Rpass=vectorize into --remark vectorize, and -emit-bc into --emit-bc.
+ */
+static std::vector<std::string> normalize_args(int argc, char *argv[])
+{
+    std::vector<std::string> args;
+    for (auto i = 0; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.size() > 2 && arg.rfind("-f", 0) == 0)
+        {
+            auto equals = arg.find('=');
+            args.push_back("--" + arg.substr(2, equals - 2));
+            if (equals != std::string::npos)
+            {
+                args.push_back(arg.substr(equals + 1));
+            }
+        }
+        else if (arg == "-emit-bc")
+        {
+            args.push_back("--emit-bc");
+        }
+        else if (arg.rfind("-Rpass=", 0) == 0)
+        {
+            args.push_back("--remark");
+            args.push_back(arg.substr(7));
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+    return args;
+}
+
+const std::string version = "1.0";
 
 struct Args
 {
@@ -15,25 +64,77 @@ struct Args
     std::string output;
     bool dump;
     bool emit_llvm;
+    bool emit_bc;
     bool link_test;
+    bool dump_liveness;
+    bool lto;
+    std::string cache_dir;
+    int cache_size;
+    bool cache_stats;
+    bool incremental;
+    bool time_report;
+    bool mem_report;
+    std::string report_json;
+    std::string time_trace;
+    Options options;
 
+    // the report of the time and memory the compilation takes, or null if none was asked for
+    std::unique_ptr<Report> report;
 
     Args(int argc, char *argv[])
     {
-        TCLAP::CmdLine cmd("Alexander's C Compiler", ' ', "1.0");
+        TCLAP::CmdLine cmd("Alexander's C Compiler", ' ', version);
         TCLAP::ValueArg<std::string> output_arg("o", "output", "Specify the output file", false, "", "string", cmd);
         TCLAP::SwitchArg dump_arg("d", "dump", "Dump intermediate representations", cmd, false);
         TCLAP::SwitchArg emit_llvm_arg("S", "emit-llvm", "Emit LLVM for compiled files", cmd, false);
+        TCLAP::SwitchArg emit_bc_arg("", "emit-bc", "Emit LLVM bitcode for compiled files (-emit-bc)", cmd, false);
         TCLAP::SwitchArg link_test_arg("T", "link-test", "Link test LLVM files", cmd, false);
-        TCLAP::UnlabeledMultiArg<std::string> file_args("files", "The files to compile", true, "string", cmd);
+        TCLAP::SwitchArg dump_liveness_arg("L", "dump-liveness", "Dump the live-set sizes of each basic block", cmd, false);
+        TCLAP::SwitchArg lto_arg("", "lto", "Link the files and the test LLVM files in memory and optimize them as one program into an object file (-flto)", cmd, false);
+        TCLAP::ValueArg<std::string> cache_dir_arg("", "cache-dir", "Cache the compiled files in the directory (-fcache-dir=DIR)", false, "", "string", cmd);
+        TCLAP::ValueArg<int> cache_size_arg("", "cache-size", "The most megabytes the cache keeps before evicting the least recently used files (-fcache-size=MB)", false, 256, "int", cmd);
+        TCLAP::SwitchArg cache_stats_arg("", "cache-stats", "Print the hits, misses and evictions of the cache (-fcache-stats)", cmd, false);
+        TCLAP::SwitchArg incremental_arg("", "incremental", "Cache each function, and only optimize and generate the functions that changed (-fincremental)", cmd, false);
+        TCLAP::SwitchArg time_report_arg("", "time-report", "Print the wall and CPU time of each phase of the compiler (-ftime-report)", cmd, false);
+        TCLAP::SwitchArg mem_report_arg("", "mem-report", "Print the peak memory, the allocations, and the number of tokens, AST nodes, quads, temps and basic blocks (-fmem-report)", cmd, false);
+        TCLAP::ValueArg<std::string> report_json_arg("", "report-json", "Write the time and memory reports to the file as JSON (-freport-json=FILE)", false, "", "string", cmd);
+        TCLAP::ValueArg<std::string> time_trace_arg("", "time-trace", "Write a Chrome trace of the phases, functions and passes of the compiler to the file (-ftime-trace=FILE)", false, "", "string", cmd);
+        TCLAP::SwitchArg fast_math_arg("", "fast-math", "Allow unsafe floating point optimizations (-ffast-math)", cmd, false);
+        TCLAP::SwitchArg no_vectorize_arg("", "no-vectorize", "Do not vectorize loops (-fno-vectorize)", cmd, false);
+        TCLAP::SwitchArg whole_program_arg("", "whole-program", "Assume no other files access the globals and functions of the compiled files, so functions can be specialized and removed (-fwhole-program)", cmd, false);
+        TCLAP::SwitchArg bounds_check_arg("", "bounds-check", "Trap on out of bounds accesses to arrays of known size (-fbounds-check)", cmd, false);
+        TCLAP::SwitchArg unroll_loops_arg("", "unroll-loops", "Unroll every counted loop (-funroll-loops)", cmd, false);
+        TCLAP::ValueArg<int> unroll_count_arg("", "unroll-count", "The unroll factor for loops without a known trip count (-funroll-count=N)", false, 4, "int", cmd);
+        TCLAP::MultiArg<std::string> remark_arg("", "remark", "Report what the pass did (-Rpass=vectorize, -Rpass=unroll, -Rpass=bounds-check, -Rpass=promote-globals, -Rpass=ipcp, -Rpass=globaldce)", false, "pass", cmd);
+        TCLAP::UnlabeledMultiArg<std::string> file_args("files", "The files to compile, and .ll or .bc files to link with them", true, "string", cmd);
 
-        cmd.parse(argc, argv);
+        auto normalized_args = normalize_args(argc, argv);
+        cmd.parse(normalized_args);
 
         files = file_args.getValue();
         output = output_arg.getValue();
         dump = dump_arg.getValue();
         emit_llvm = emit_llvm_arg.getValue();
+        emit_bc = emit_bc_arg.getValue();
         link_test = link_test_arg.getValue();
+        dump_liveness = dump_liveness_arg.getValue();
+        lto = lto_arg.getValue();
+        cache_dir = cache_dir_arg.getValue();
+        cache_size = cache_size_arg.getValue();
+        cache_stats = cache_stats_arg.getValue();
+        incremental = incremental_arg.getValue();
+        time_report = time_report_arg.getValue();
+        mem_report = mem_report_arg.getValue();
+        report_json = report_json_arg.getValue();
+        time_trace = time_trace_arg.getValue();
+        options.fast_math = fast_math_arg.getValue();
+        options.vectorize = !no_vectorize_arg.getValue();
+        options.whole_program = whole_program_arg.getValue();
+        options.bounds_check = bounds_check_arg.getValue();
+        options.unroll_loops = unroll_loops_arg.getValue();
+        options.unroll_count = unroll_count_arg.getValue();
+        auto remarks = remark_arg.getValue();
+        options.remarks.insert(remarks.begin(), remarks.end());
     }
 };
 
@@ -74,35 +175,190 @@ static void link_llvm(Args& args, std::vector<std::string> llvm_files)
     std::system(link_cmd.c_str());
 }
 
-int main(int argc, char *argv[])
+/**
+ * Compiles the source down to the IR and optimizes it, dumping the representations that were asked for.
+ * The functions that find_cached returns are not optimized, see Program::ir_optimize.
+ */
+static std::shared_ptr<Program> compile(Args& args, const std::string& input, const std::function<std::set<FunctionDef *>(std::vector<std::shared_ptr<FunctionDef>>&)>& find_cached = nullptr)
 {
-    Args args(argc, argv);
+    auto report = args.report.get();
+    auto lexer = time_phase(report, "lex", [&]() { return Lexer(input); });
+    Parser parser(lexer);
+    auto program = time_phase(report, "parse", [&]() { return parser.parse(); });
 
-    try
+    if (args.dump)
     {
-        // for now, process just the first file passed
-        std::string input = read_file(args.files[0]);
+        std::cerr << "AST DUMP:\n";
+        program->dump();
+        std::cerr << "\n";
+    }
 
-        Lexer lexer(input);
-        Parser parser(lexer);
-        auto program = parser.parse();
+    time_phase(report, "ir codegen", [&]() { program->ir_codegen(); });
+    time_phase(report, "ir optimize", [&]() { program->ir_optimize(args.options, find_cached); });
+    if (report != nullptr)
+    {
+        report->add_count("tokens", lexer.size());
+        report->count_program(program);
+    }
 
-        if (args.dump)
+    if (args.dump)
+    {
+        std::cerr << "IR DUMP:\n";
+        program->ir_dump();
+        std::cerr << "\n";
+    }
+
+    if (args.dump_liveness)
+    {
+        std::cerr << "LIVENESS DUMP:\n";
+        program->liveness_dump();
+    }
+
+    return program;
+}
+
+/**
+ * Compiles the file into a module, or loads it from the cache if it was compiled before with the same options.
+ * The cache is null if it is disabled. With -fincremental, a file that is not cached is compiled with the cached code
+ * of the functions that did not change.
+ */
+static std::unique_ptr<llvm::Module> compile_module(Args& args, CompileCache *cache, const std::string& file, llvm::LLVMContext& llvm_context)
+{
+    auto report = args.report.get();
+    auto input = time_phase(report, "read", [&]() { return read_file(file); });
+
+    std::string key;
+    std::unique_ptr<llvm::Module> module;
+    if (cache != nullptr)
+    {
+        key = CompileCache::get_key(input, version, args.options);
+        module = time_phase(report, "cache", [&]() { return cache->load(key, llvm_context); });
+    }
+
+    if (module == nullptr && cache != nullptr && args.incremental)
+    {
+        std::set<FunctionDef *> cached;
+        auto program = compile(args, input, [&](std::vector<std::shared_ptr<FunctionDef>>& functions)
+        {
+            cached = time_phase(report, "cache", [&]() { return cache->load_functions(functions, version, args.options, llvm_context); });
+            return cached;
+        });
+
+        module = time_phase(report, "codegen", [&]() { return codegen(program, llvm_context, args.options, cached); });
+        time_phase(report, "cache", [&]()
         {
-            std::cerr << "AST DUMP:\n";
-            program->dump();
-            std::cerr << "\n";
+            cache->link_functions(*module, program->functions);
+            cache->store(key, *module);
+        });
+    }
+    else if (module == nullptr)
+    {
+        auto program = compile(args, input);
+        module = time_phase(report, "codegen", [&]() { return codegen(program, llvm_context, args.options); });
+        if (cache != nullptr)
+        {
+            time_phase(report, "cache", [&]() { cache->store(key, *module); });
         }
+    }
+
+    module->setModuleIdentifier(file);
+    return module;
+}
 
-        program->ir_codegen();
+/**
+ * Checks if the file is LLVM IR or bitcode, which is linked without being compiled.
+ */
+static bool is_llvm_file(const std::string& file)
+{
+    auto extension = file.substr(file.find_last_of('.') + 1);
+    return extension == "ll" || extension == "bc";
+}
+
+/**
+ * Gets the file the bitcode of the compiled file is written to with -emit-bc, e.g. dir/prog.c to prog.bc.
+ */
+static std::string get_bitcode_output(Args& args, const std::string& file)
+{
+    if (!args.output.empty())
+    {
+        return args.output;
+    }
+
+    auto name = file.substr(file.find_last_of('/') + 1);
+    return name.substr(0, name.find_last_of('.')) + ".bc";
+}
+
+/**
+ * Compiles the files into modules in one LLVM context, links them with the LLVM files and the test LLVM files and
+ * optimizes the whole program, then emits it as an object file, or as LLVM if it is asked for.
+ */
+static void compile_lto(Args& args, CompileCache *cache)
+{
+    llvm::LLVMContext llvm_context;
+    std::vector<std::unique_ptr<llvm::Module>> modules;
+    std::vector<std::string> llvm_files;
+    for (auto& file : args.files)
+    {
+        if (is_llvm_file(file))
+        {
+            llvm_files.push_back(file);
+            continue;
+        }
+
+        modules.push_back(compile_module(args, cache, file, llvm_context));
+    }
 
+    if (args.link_test)
+    {
+        llvm_files.push_back("acc-link/test-code.ll");
+    }
+
+    auto module = time_phase(args.report.get(), "lto", [&]() { return link_time_optimize(std::move(modules), llvm_files, llvm_context); });
+    if (args.emit_llvm || args.dump)
+    {
         if (args.dump)
         {
-            std::cerr << "IR DUMP:\n";
-            program->ir_dump();
-            std::cerr << "\n";
+            std::cerr << "LLVM DUMP:\n";
+        }
+
+        llvm::raw_os_ostream stream(std::cout);
+        module->print(stream, nullptr);
+    }
+    else if (args.emit_bc)
+    {
+        time_phase(args.report.get(), "emit", [&]() { emit_bitcode(*module, args.output.empty() ? "a.bc" : args.output); });
+    }
+    else
+    {
+        time_phase(args.report.get(), "emit", [&]() { emit_object(*module, args.output.empty() ? "a.o" : args.output); });
+    }
+}
+
+/**
+ * Compiles each file into LLVM, then links them with the LLVM files into an executable unless LLVM is asked for.
+ * The compiled files are written as bitcode, which llvm-link loads faster than textual IR, to unique temporary files
+ * so that they never overwrite the files of the user or of another compilation.
+ */
+static void compile_files(Args& args, CompileCache *cache)
+{
+    llvm::LLVMContext llvm_context;
+    std::vector<std::string> llvm_files;
+    std::vector<std::string> temp_files;
+    auto sources = std::count_if(args.files.begin(), args.files.end(), [](auto& file) { return !is_llvm_file(file); });
+    if (args.emit_bc && !args.output.empty() && sources > 1)
+    {
+        error("cannot specify -o with -emit-bc when compiling multiple files");
+    }
+
+    for (auto& file : args.files)
+    {
+        if (is_llvm_file(file))
+        {
+            llvm_files.push_back(file);
+            continue;
         }
 
+        auto module = compile_module(args, cache, file, llvm_context);
         if (args.emit_llvm || args.dump)
         {
             if (args.dump)
@@ -110,30 +366,177 @@ int main(int argc, char *argv[])
                 std::cerr << "LLVM DUMP:\n";
             }
 
-            codegen(program, &std::cout);
+            llvm::raw_os_ostream stream(std::cout);
+            module->print(stream, nullptr);
+        }
+        else if (args.emit_bc)
+        {
+            time_phase(args.report.get(), "emit", [&]() { emit_bitcode(*module, get_bitcode_output(args, file)); });
         }
         else
-        {   
-            auto llvm_output = "a.ll";
+        {
+            llvm::SmallString<128> temp_path;
+            if (llvm::sys::fs::createTemporaryFile("acc", "bc", temp_path))
             {
-                std::ofstream llvm_output_stream(llvm_output);
-                codegen(program, &llvm_output_stream);
+                error("could not create a temporary file for " + file);
             }
 
-            std::vector<std::string> llvm_files;
-            llvm_files.push_back(llvm_output);
-            link_llvm(args, llvm_files);
+            auto llvm_output = temp_path.str().str();
+            temp_files.push_back(llvm_output);
+            time_phase(args.report.get(), "emit", [&]() { emit_bitcode(*module, llvm_output); });
+        }
+    }
 
-            for (auto& file : llvm_files) 
-            {
-                std::remove(file.c_str());
-            }
+    if (!args.emit_llvm && !args.dump && !args.emit_bc)
+    {
+        llvm_files.insert(llvm_files.begin(), temp_files.begin(), temp_files.end());
+        time_phase(args.report.get(), "link", [&]() { link_llvm(args, llvm_files); });
+
+        for (auto& file : temp_files) 
+        {
+            std::remove(file.c_str());
         }
     }
+}
+
+/**
+ * Prints the reports that were asked for to stderr, and writes the JSON report.
+ */
+static void print_report(Args& args)
+{
+    if (args.time_report)
+    {
+        args.report->print_time(std::cerr);
+    }
+
+    if (args.mem_report)
+    {
+        args.report->print_memory(std::cerr);
+    }
+
+    if (!args.report_json.empty())
+    {
+        std::ofstream json(args.report_json);
+        if (!json.good())
+        {
+            error("could not write " + args.report_json);
+        }
+
+        args.report->write_json(json);
+    }
+}
+
+/**
+ * Writes the Chrome trace of the compilation, if -ftime-trace asked for one.
+ */
+static void write_time_trace(Args& args)
+{
+    if (args.time_trace.empty())
+    {
+        return;
+    }
+
+    auto result = llvm::timeTraceProfilerWrite(args.time_trace, "");
+    llvm::timeTraceProfilerCleanup();
+    if (result)
+    {
+        llvm::consumeError(std::move(result));
+        error("could not write " + args.time_trace);
+    }
+}
+
+/**
+ * Runs acc with the arguments and returns the exit status.
+ */
+static int run(int argc, char *argv[])
+{
+    Args args(argc, argv);
+    if (args.time_report || args.mem_report || !args.report_json.empty())
+    {
+        args.report = std::make_unique<Report>();
+    }
+
+    if (!args.time_trace.empty())
+    {
+        llvm::timeTraceProfilerInitialize(0, "acc");
+    }
+
+    try
+    {
+        // the dumps and remarks are printed while compiling, so they would be missing on a hit
+        std::unique_ptr<CompileCache> cache;
+        if (args.incremental && args.cache_dir.empty())
+        {
+            error("-fincremental needs a cache directory, set with -fcache-dir");
+        }
+
+        if (args.options.unroll_count < 1)
+        {
+            error("-funroll-count must be at least 1");
+        }
+
+        if (!args.cache_dir.empty() && !args.dump && !args.dump_liveness && args.options.remarks.empty())
+        {
+            cache = std::make_unique<CompileCache>(args.cache_dir, (std::uintmax_t)args.cache_size << 20);
+        }
+
+        if (args.lto)
+        {
+            compile_lto(args, cache.get());
+        }
+        else
+        {
+            compile_files(args, cache.get());
+        }
+
+        if (args.cache_stats && cache != nullptr)
+        {
+            cache->print_stats(std::cerr);
+        }
+
+        print_report(args);
+        write_time_trace(args);
+    }
     catch(Error& e)
     {
         std::cerr << e.what();
     }
+    catch (std::runtime_error& e)
+    {
+        error(e.what());
+    }
     
     return 0;
 }
+
+int main(int argc, char *argv[])
+{
+    // the server and client modes must come first, and the client forwards the rest of the arguments to the server
+    std::string mode = argc > 1 ? argv[1] : "";
+    try
+    {
+        if (mode == "--server")
+        {
+            run_server(get_server_socket_path(), std::thread::hardware_concurrency(), [&](const std::vector<std::string>& args)
+            {
+                std::vector<char *> request_argv = { argv[0] };
+                for (auto& arg : args)
+                {
+                    request_argv.push_back((char *)arg.c_str());
+                }
+
+                return run(request_argv.size(), request_argv.data());
+            });
+        }
+        else if (mode == "--connect")
+        {
+            return run_client(get_server_socket_path(), std::vector<std::string>(argv + 2, argv + argc));
+        }
+    }
+    catch (std::runtime_error& e)
+    {
+        error(e.what());
+    }
+
+    return run(argc, argv);
+}